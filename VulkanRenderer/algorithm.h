@@ -20,4 +20,19 @@ namespace vkr::algorithm {
         }
         return result;
     }
+
+    template <class T>
+    constexpr auto coalesce(std::vector<std::pair<T, T>>& ranges) -> void {
+        std::sort(ranges.begin(), ranges.end());
+        size_t count = 0;
+        for (const auto& range : ranges) {
+            if (count > 0 && range.first <= ranges[count - 1].second) {
+                ranges[count - 1].second = std::max(ranges[count - 1].second, range.second);
+            }
+            else {
+                ranges[count++] = range;
+            }
+        }
+        ranges.resize(count);
+    }
 }
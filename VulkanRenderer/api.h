@@ -11,13 +11,38 @@ namespace vkr::api {
         eDisabled
     };
 
+    // How levels are built for images filled on the GPU, such as dynamic textures. Static textures build theirs on
+    // the CPU before upload.
+    enum class MipGenerator {
+        eBlit,
+        eCompute
+    };
+
+    // Where the draws of a frame are recorded. GPU culling builds them in compute and issues one indirect draw, and
+    // falls back to CPU recording when drawIndirectCount is missing. CPU recording issues one instanced draw per mesh,
+    // split across recordingThreads secondary command buffers.
+    enum class DrawPath {
+        eGpuCulling,
+        eCpuRecording
+    };
+
     struct RendererCreateInfo {
         DebuggerMinimunLevel debuggerMinimumLevel = DebuggerMinimunLevel::eDisabled;
         vk::SampleCountFlagBits maxAntialiasing = vk::SampleCountFlagBits::e1;
+        // Starting size of each frame's region of the frame data ring, which doubles whenever a frame outgrows it.
+        vk::DeviceSize frameDataSize = 4ull * 1024 * 1024;
+        size_t recordingThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        float lodErrorThreshold = 1.0f;
+        float lodHysteresis = 0.25f;
+        MipGenerator mipGenerator = MipGenerator::eCompute;
+        DrawPath drawPath = DrawPath::eGpuCulling;
         std::function<size_t(std::vector<vk::PhysicalDeviceProperties>)> deviceSelector = [](std::vector<vk::PhysicalDeviceProperties>) {
             return 0;
         };
         std::function<void(float delta, float time)> onUpdate = [](float, float) {};
+        std::function<void(std::span<const uint8_t> pixels, glm::uvec2 size)> onFrame = [](std::span<const uint8_t>, glm::uvec2) {};
+        std::function<void(uint64_t frame, double gpuMilliseconds)> onGpuTime = [](uint64_t, double) {};
+        bool headless = false;
         io::WindowCreateInfo windowCreateInfo;
     };
 }
\ No newline at end of file
@@ -0,0 +1,807 @@
+#include "bc.h"
+
+namespace vkr::bc {
+    namespace {
+        using Texel = std::array<uint8_t, 4>;
+        using Block = std::array<Texel, 16>;
+
+        constexpr std::array<uint32_t, 16> bc7Weights = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        class BitWriter {
+        public:
+            auto write(uint64_t value, uint32_t count) -> void {
+                for (uint32_t i = 0; i < count; ++i, ++position) {
+                    words[position / 64] |= ((value >> i) & 1) << (position % 64);
+                }
+            }
+            auto store(uint8_t* destination) const -> void {
+                memcpy(destination, words.data(), sizeof(words));
+            }
+        private:
+            std::array<uint64_t, 2> words = {};
+            uint32_t position = 0;
+        };
+
+        class BitReader {
+        public:
+            BitReader(const uint8_t* source) {
+                memcpy(words.data(), source, sizeof(words));
+            }
+            auto read(uint32_t count) -> uint32_t {
+                uint32_t value = 0;
+                for (uint32_t i = 0; i < count; ++i, ++position) {
+                    value |= static_cast<uint32_t>((words[position / 64] >> (position % 64)) & 1) << i;
+                }
+                return value;
+            }
+        private:
+            std::array<uint64_t, 2> words = {};
+            uint32_t position = 0;
+        };
+
+        auto isSrgb(vk::Format format) -> bool {
+            switch (format) {
+            case vk::Format::eBc1RgbSrgbBlock:
+            case vk::Format::eBc1RgbaSrgbBlock:
+            case vk::Format::eBc3SrgbBlock:
+            case vk::Format::eBc7SrgbBlock:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        // The principal axis of the block's colors, found by power iteration on their covariance. Endpoints are placed
+        // along it, which fits gradients far better than the bounding box diagonal.
+        template <size_t N>
+        auto getPrincipalAxis(const Block& block, std::array<float, N>& mean) -> std::array<float, N> {
+            mean = {};
+            std::array<float, N> low;
+            std::array<float, N> high;
+            low.fill(255.0f);
+            high.fill(0.0f);
+            for (const Texel& texel : block) {
+                for (size_t c = 0; c < N; ++c) {
+                    mean[c] += texel[c] / 16.0f;
+                    low[c] = std::min(low[c], static_cast<float>(texel[c]));
+                    high[c] = std::max(high[c], static_cast<float>(texel[c]));
+                }
+            }
+
+            std::array<std::array<float, N>, N> covariance = {};
+            for (const Texel& texel : block) {
+                for (size_t i = 0; i < N; ++i) {
+                    for (size_t j = 0; j < N; ++j) {
+                        covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+                    }
+                }
+            }
+
+            std::array<float, N> axis;
+            for (size_t c = 0; c < N; ++c) {
+                axis[c] = high[c] - low[c];
+            }
+            for (uint32_t iteration = 0; iteration < 8; ++iteration) {
+                std::array<float, N> next = {};
+                for (size_t i = 0; i < N; ++i) {
+                    for (size_t j = 0; j < N; ++j) {
+                        next[i] += covariance[i][j] * axis[j];
+                    }
+                }
+                float length = 0.0f;
+                for (float value : next) {
+                    length = std::max(length, std::abs(value));
+                }
+                if (length == 0.0f) {
+                    break;
+                }
+                for (size_t c = 0; c < N; ++c) {
+                    axis[c] = next[c] / length;
+                }
+            }
+
+            float length = 0.0f;
+            for (float value : axis) {
+                length += value * value;
+            }
+            if (length > 0.0f) {
+                for (float& value : axis) {
+                    value /= std::sqrt(length);
+                }
+            }
+            return axis;
+        }
+
+        template <size_t N>
+        auto getEndpoints(const Block& block) -> std::array<std::array<float, N>, 2> {
+            std::array<float, N> mean;
+            std::array<float, N> axis = getPrincipalAxis<N>(block, mean);
+
+            float low = 0.0f;
+            float high = 0.0f;
+            for (const Texel& texel : block) {
+                float t = 0.0f;
+                for (size_t c = 0; c < N; ++c) {
+                    t += (texel[c] - mean[c]) * axis[c];
+                }
+                low = std::min(low, t);
+                high = std::max(high, t);
+            }
+
+            std::array<std::array<float, N>, 2> endpoints;
+            for (size_t c = 0; c < N; ++c) {
+                endpoints[0][c] = std::clamp(mean[c] + axis[c] * low, 0.0f, 255.0f);
+                endpoints[1][c] = std::clamp(mean[c] + axis[c] * high, 0.0f, 255.0f);
+            }
+            return endpoints;
+        }
+
+        // Least squares endpoints for a fixed index assignment, where weights[i] is how much of the second endpoint
+        // texel i takes. Returns false when the assignment doesn't determine both endpoints.
+        template <size_t N>
+        auto refineEndpoints(const Block& block, const std::array<float, 16>& weights, std::array<std::array<float, N>, 2>& endpoints) -> bool {
+            float aa = 0.0f;
+            float ab = 0.0f;
+            float bb = 0.0f;
+            std::array<float, N> ax = {};
+            std::array<float, N> bx = {};
+            for (size_t i = 0; i < 16; ++i) {
+                float b = weights[i];
+                float a = 1.0f - b;
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for (size_t c = 0; c < N; ++c) {
+                    ax[c] += a * block[i][c];
+                    bx[c] += b * block[i][c];
+                }
+            }
+
+            float determinant = aa * bb - ab * ab;
+            if (std::abs(determinant) < 1e-6f) {
+                return false;
+            }
+            for (size_t c = 0; c < N; ++c) {
+                endpoints[0][c] = std::clamp((bb * ax[c] - ab * bx[c]) / determinant, 0.0f, 255.0f);
+                endpoints[1][c] = std::clamp((aa * bx[c] - ab * ax[c]) / determinant, 0.0f, 255.0f);
+            }
+            return true;
+        }
+
+        auto pack565(const std::array<float, 3>& color) -> uint16_t {
+            auto r = static_cast<uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+            auto g = static_cast<uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+            auto b = static_cast<uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+            return static_cast<uint16_t>(r << 11 | g << 5 | b);
+        }
+
+        auto unpack565(uint16_t color) -> std::array<int32_t, 3> {
+            int32_t r = (color >> 11) & 31;
+            int32_t g = (color >> 5) & 63;
+            int32_t b = color & 31;
+            return { r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2 };
+        }
+
+        auto getColorPalette(uint16_t color0, uint16_t color1, bool fourColors) -> std::array<Texel, 4> {
+            std::array<int32_t, 3> a = unpack565(color0);
+            std::array<int32_t, 3> b = unpack565(color1);
+
+            std::array<Texel, 4> palette;
+            for (size_t c = 0; c < 3; ++c) {
+                palette[0][c] = static_cast<uint8_t>(a[c]);
+                palette[1][c] = static_cast<uint8_t>(b[c]);
+                if (fourColors) {
+                    palette[2][c] = static_cast<uint8_t>((2 * a[c] + b[c]) / 3);
+                    palette[3][c] = static_cast<uint8_t>((a[c] + 2 * b[c]) / 3);
+                }
+                else {
+                    palette[2][c] = static_cast<uint8_t>((a[c] + b[c]) / 2);
+                    palette[3][c] = 0;
+                }
+            }
+            palette[0][3] = 255;
+            palette[1][3] = 255;
+            palette[2][3] = 255;
+            palette[3][3] = fourColors ? 255 : 0;
+            return palette;
+        }
+
+        auto fitColorIndices(const Block& block, uint16_t color0, uint16_t color1, std::array<uint8_t, 16>& indices) -> int32_t {
+            std::array<Texel, 4> palette = getColorPalette(color0, color1, true);
+
+            int32_t total = 0;
+            for (size_t i = 0; i < 16; ++i) {
+                int32_t best = std::numeric_limits<int32_t>::max();
+                for (uint8_t index = 0; index < 4; ++index) {
+                    int32_t error = 0;
+                    for (size_t c = 0; c < 3; ++c) {
+                        int32_t difference = block[i][c] - palette[index][c];
+                        error += difference * difference;
+                    }
+                    if (error < best) {
+                        best = error;
+                        indices[i] = index;
+                    }
+                }
+                total += best;
+            }
+            return total;
+        }
+
+        // Always emits four color blocks, so the same encoder serves BC1 and the color half of BC3.
+        auto encodeColor(const Block& block, uint8_t* destination) -> void {
+            constexpr std::array<float, 4> weights = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+            auto endpoints = getEndpoints<3>(block);
+            uint16_t color0 = pack565(endpoints[1]);
+            uint16_t color1 = pack565(endpoints[0]);
+            std::array<uint8_t, 16> indices;
+            int32_t error = fitColorIndices(block, color0, color1, indices);
+
+            std::array<float, 16> fit;
+            for (size_t i = 0; i < 16; ++i) {
+                fit[i] = weights[indices[i]];
+            }
+            std::array<std::array<float, 3>, 2> refined;
+            if (error > 0 && refineEndpoints<3>(block, fit, refined)) {
+                uint16_t refined0 = pack565(refined[0]);
+                uint16_t refined1 = pack565(refined[1]);
+                std::array<uint8_t, 16> refinedIndices;
+                if (fitColorIndices(block, refined0, refined1, refinedIndices) < error) {
+                    color0 = refined0;
+                    color1 = refined1;
+                    indices = refinedIndices;
+                }
+            }
+
+            if (color0 < color1) {
+                std::swap(color0, color1);
+                for (uint8_t& index : indices) {
+                    index ^= 1;
+                }
+            }
+            if (color0 == color1) {
+                indices.fill(0);
+            }
+
+            uint32_t bits = 0;
+            for (size_t i = 0; i < 16; ++i) {
+                bits |= static_cast<uint32_t>(indices[i]) << (2 * i);
+            }
+            memcpy(destination, &color0, sizeof(color0));
+            memcpy(destination + 2, &color1, sizeof(color1));
+            memcpy(destination + 4, &bits, sizeof(bits));
+        }
+
+        auto getChannelPalette(uint8_t value0, uint8_t value1) -> std::array<uint8_t, 8> {
+            std::array<uint8_t, 8> palette = { value0, value1 };
+            if (value0 > value1) {
+                for (uint32_t i = 1; i < 7; ++i) {
+                    palette[i + 1] = static_cast<uint8_t>(((7 - i) * value0 + i * value1 + 3) / 7);
+                }
+            }
+            else {
+                for (uint32_t i = 1; i < 5; ++i) {
+                    palette[i + 1] = static_cast<uint8_t>(((5 - i) * value0 + i * value1 + 2) / 5);
+                }
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+            return palette;
+        }
+
+        // One BC4 block for a single channel, always in the eight value mode spanning the channel's range.
+        auto encodeChannel(const Block& block, size_t channel, uint8_t* destination) -> void {
+            uint8_t low = 255;
+            uint8_t high = 0;
+            for (const Texel& texel : block) {
+                low = std::min(low, texel[channel]);
+                high = std::max(high, texel[channel]);
+            }
+
+            uint64_t bits = 0;
+            if (high > low) {
+                std::array<uint8_t, 8> palette = getChannelPalette(high, low);
+                for (size_t i = 0; i < 16; ++i) {
+                    uint64_t best = 0;
+                    for (uint64_t index = 1; index < 8; ++index) {
+                        if (std::abs(block[i][channel] - palette[index]) < std::abs(block[i][channel] - palette[best])) {
+                            best = index;
+                        }
+                    }
+                    bits |= best << (3 * i);
+                }
+            }
+
+            destination[0] = high;
+            destination[1] = low;
+            for (size_t i = 0; i < 6; ++i) {
+                destination[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+            }
+        }
+
+        // Picks the parity bit that lands the 7-bit endpoint closest to the unquantized one.
+        auto quantizeBc7Endpoint(const std::array<float, 4>& endpoint, std::array<uint8_t, 4>& quantized) -> uint8_t {
+            float bestError = std::numeric_limits<float>::max();
+            uint8_t bestParity = 0;
+            for (uint8_t parity = 0; parity < 2; ++parity) {
+                std::array<uint8_t, 4> candidate;
+                float error = 0.0f;
+                for (size_t c = 0; c < 4; ++c) {
+                    candidate[c] = static_cast<uint8_t>(std::clamp(std::lround((endpoint[c] - parity) / 2.0f), 0l, 127l));
+                    float difference = static_cast<float>(candidate[c] << 1 | parity) - endpoint[c];
+                    error += difference * difference;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    bestParity = parity;
+                    quantized = candidate;
+                }
+            }
+            return bestParity;
+        }
+
+        struct Bc7Endpoints {
+            std::array<std::array<uint8_t, 4>, 2> colors = {};
+            std::array<uint8_t, 2> parities = {};
+        };
+
+        auto getBc7Palette(const Bc7Endpoints& endpoints) -> std::array<Texel, 16> {
+            std::array<Texel, 16> palette;
+            for (size_t c = 0; c < 4; ++c) {
+                uint32_t a = static_cast<uint32_t>(endpoints.colors[0][c] << 1 | endpoints.parities[0]);
+                uint32_t b = static_cast<uint32_t>(endpoints.colors[1][c] << 1 | endpoints.parities[1]);
+                for (size_t index = 0; index < 16; ++index) {
+                    palette[index][c] = static_cast<uint8_t>(((64 - bc7Weights[index]) * a + bc7Weights[index] * b + 32) >> 6);
+                }
+            }
+            return palette;
+        }
+
+        auto fitBc7Indices(const Block& block, const Bc7Endpoints& endpoints, std::array<uint8_t, 16>& indices) -> int32_t {
+            std::array<Texel, 16> palette = getBc7Palette(endpoints);
+
+            int32_t total = 0;
+            for (size_t i = 0; i < 16; ++i) {
+                int32_t best = std::numeric_limits<int32_t>::max();
+                for (uint8_t index = 0; index < 16; ++index) {
+                    int32_t error = 0;
+                    for (size_t c = 0; c < 4; ++c) {
+                        int32_t difference = block[i][c] - palette[index][c];
+                        error += difference * difference;
+                    }
+                    if (error < best) {
+                        best = error;
+                        indices[i] = index;
+                    }
+                }
+                total += best;
+            }
+            return total;
+        }
+
+        auto quantizeBc7Endpoints(const std::array<std::array<float, 4>, 2>& endpoints) -> Bc7Endpoints {
+            Bc7Endpoints quantized;
+            quantized.parities[0] = quantizeBc7Endpoint(endpoints[0], quantized.colors[0]);
+            quantized.parities[1] = quantizeBc7Endpoint(endpoints[1], quantized.colors[1]);
+            return quantized;
+        }
+
+        // Mode 6 only: a single RGBA line with 4-bit indices and per endpoint parity bits. It handles alpha without a
+        // separate channel and is the mode most BC7 encoders settle on for smooth content.
+        auto encodeBc7(const Block& block, uint8_t* destination) -> void {
+            Bc7Endpoints endpoints = quantizeBc7Endpoints(getEndpoints<4>(block));
+            std::array<uint8_t, 16> indices;
+            int32_t error = fitBc7Indices(block, endpoints, indices);
+
+            std::array<float, 16> fit;
+            for (size_t i = 0; i < 16; ++i) {
+                fit[i] = static_cast<float>(bc7Weights[indices[i]]) / 64.0f;
+            }
+            std::array<std::array<float, 4>, 2> refined;
+            if (error > 0 && refineEndpoints<4>(block, fit, refined)) {
+                Bc7Endpoints refinedEndpoints = quantizeBc7Endpoints(refined);
+                std::array<uint8_t, 16> refinedIndices;
+                if (fitBc7Indices(block, refinedEndpoints, refinedIndices) < error) {
+                    endpoints = refinedEndpoints;
+                    indices = refinedIndices;
+                }
+            }
+
+            // The first index is stored without its top bit, so it has to fall in the lower half.
+            if (indices[0] >= 8) {
+                std::swap(endpoints.colors[0], endpoints.colors[1]);
+                std::swap(endpoints.parities[0], endpoints.parities[1]);
+                for (uint8_t& index : indices) {
+                    index = static_cast<uint8_t>(15 - index);
+                }
+            }
+
+            BitWriter writer;
+            writer.write(1 << 6, 7);
+            for (size_t c = 0; c < 4; ++c) {
+                writer.write(endpoints.colors[0][c], 7);
+                writer.write(endpoints.colors[1][c], 7);
+            }
+            writer.write(endpoints.parities[0], 1);
+            writer.write(endpoints.parities[1], 1);
+            writer.write(indices[0], 3);
+            for (size_t i = 1; i < 16; ++i) {
+                writer.write(indices[i], 4);
+            }
+            writer.store(destination);
+        }
+
+        auto encodeBlock(const Block& block, vk::Format format, uint8_t* destination) -> void {
+            switch (format) {
+            case vk::Format::eBc1RgbUnormBlock:
+            case vk::Format::eBc1RgbSrgbBlock:
+            case vk::Format::eBc1RgbaUnormBlock:
+            case vk::Format::eBc1RgbaSrgbBlock:
+                encodeColor(block, destination);
+                break;
+            case vk::Format::eBc3UnormBlock:
+            case vk::Format::eBc3SrgbBlock:
+                encodeChannel(block, 3, destination);
+                encodeColor(block, destination + 8);
+                break;
+            case vk::Format::eBc4UnormBlock:
+                encodeChannel(block, 0, destination);
+                break;
+            case vk::Format::eBc5UnormBlock:
+                encodeChannel(block, 0, destination);
+                encodeChannel(block, 1, destination + 8);
+                break;
+            case vk::Format::eBc7UnormBlock:
+            case vk::Format::eBc7SrgbBlock:
+                encodeBc7(block, destination);
+                break;
+            default:
+                throw std::runtime_error(fmt::format("Can't compress textures to {}", vk::to_string(format)));
+            }
+        }
+
+        auto decodeColor(const uint8_t* source, bool alwaysFourColors, bool transparent, Block& block) -> void {
+            uint16_t color0;
+            uint16_t color1;
+            uint32_t bits;
+            memcpy(&color0, source, sizeof(color0));
+            memcpy(&color1, source + 2, sizeof(color1));
+            memcpy(&bits, source + 4, sizeof(bits));
+
+            bool fourColors = alwaysFourColors || color0 > color1;
+            std::array<Texel, 4> palette = getColorPalette(color0, color1, fourColors);
+            if (!fourColors && !transparent) {
+                palette[3][3] = 255;
+            }
+            for (size_t i = 0; i < 16; ++i) {
+                block[i] = palette[(bits >> (2 * i)) & 3];
+            }
+        }
+
+        auto decodeChannel(const uint8_t* source, size_t channel, Block& block) -> void {
+            std::array<uint8_t, 8> palette = getChannelPalette(source[0], source[1]);
+            uint64_t bits = 0;
+            for (size_t i = 0; i < 6; ++i) {
+                bits |= static_cast<uint64_t>(source[2 + i]) << (8 * i);
+            }
+            for (size_t i = 0; i < 16; ++i) {
+                block[i][channel] = palette[(bits >> (3 * i)) & 7];
+            }
+        }
+
+        // Subset of every texel for the 64 partitions of the two and three subset modes, two bits per texel with texel 0 in
+        // the lowest bits. The anchor texel of each subset after the first stores its index with one bit less.
+        constexpr std::array<uint32_t, 64> bc7Partitions2 = {
+            0x50505050, 0x40404040, 0x54545454, 0x54505040, 0x50404000, 0x55545450, 0x55545040, 0x54504000,
+            0x50400000, 0x55555450, 0x55544000, 0x54400000, 0x55555440, 0x55550000, 0x55555500, 0x55000000,
+            0x55150100, 0x00004054, 0x15010000, 0x00405054, 0x00004050, 0x15050100, 0x05010000, 0x40505054,
+            0x00404050, 0x05010100, 0x14141414, 0x05141450, 0x01155440, 0x00555500, 0x15014054, 0x05414150,
+            0x44444444, 0x55005500, 0x11441144, 0x05055050, 0x05500550, 0x11114444, 0x41144114, 0x44111144,
+            0x15055054, 0x01055040, 0x05041050, 0x05455150, 0x14414114, 0x50050550, 0x41411414, 0x00141400,
+            0x00041504, 0x00105410, 0x10541000, 0x04150400, 0x50410514, 0x41051450, 0x05415014, 0x14054150,
+            0x41050514, 0x41505014, 0x40011554, 0x54150140, 0x50505500, 0x00555050, 0x15151010, 0x54540404
+        };
+        constexpr std::array<uint32_t, 64> bc7Partitions3 = {
+            0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+            0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+            0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+            0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+            0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+            0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+            0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+            0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254
+        };
+        constexpr std::array<uint8_t, 64> bc7Anchors2 = {
+            15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+            15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+            15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+            6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15
+        };
+        constexpr std::array<uint8_t, 64> bc7Anchors3Second = {
+            3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+            3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+            8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+            3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3
+        };
+        constexpr std::array<uint8_t, 64> bc7Anchors3Third = {
+            15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+            15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+            15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+            15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8
+        };
+
+        struct Bc7Mode {
+            uint32_t subsets;
+            uint32_t partitionBits;
+            uint32_t rotationBits;
+            uint32_t indexSelectionBits;
+            uint32_t colorBits;
+            uint32_t alphaBits;
+            bool endpointParity;
+            bool sharedParity;
+            uint32_t indexBits;
+            uint32_t secondaryIndexBits;
+        };
+
+        constexpr std::array<Bc7Mode, 8> bc7Modes = { {
+            { 3, 4, 0, 0, 4, 0, true, false, 3, 0 },
+            { 2, 6, 0, 0, 6, 0, false, true, 3, 0 },
+            { 3, 6, 0, 0, 5, 0, false, false, 2, 0 },
+            { 2, 6, 0, 0, 7, 0, true, false, 2, 0 },
+            { 1, 0, 2, 1, 5, 6, false, false, 2, 3 },
+            { 1, 0, 2, 0, 7, 8, false, false, 2, 2 },
+            { 1, 0, 0, 0, 7, 7, true, false, 4, 0 },
+            { 2, 6, 0, 0, 5, 5, true, false, 2, 0 },
+        } };
+
+        auto getBc7Weight(uint32_t bits, uint32_t index) -> uint32_t {
+            constexpr std::array<uint32_t, 4> weights2 = { 0, 21, 43, 64 };
+            constexpr std::array<uint32_t, 8> weights3 = { 0, 9, 18, 27, 37, 46, 55, 64 };
+            return bits == 2 ? weights2[index] : bits == 3 ? weights3[index] : bc7Weights[index];
+        }
+
+        auto decodeBc7(const uint8_t* source, Block& block) -> void {
+            BitReader reader(source);
+
+            uint32_t modeIndex = 0;
+            while (modeIndex < 8 && reader.read(1) == 0) {
+                modeIndex++;
+            }
+            if (modeIndex == 8) {
+                block.fill({ 0, 0, 0, 0 });
+                return;
+            }
+            const Bc7Mode& mode = bc7Modes[modeIndex];
+
+            uint32_t partition = reader.read(mode.partitionBits);
+            uint32_t rotation = reader.read(mode.rotationBits);
+            uint32_t indexSelection = reader.read(mode.indexSelectionBits);
+
+            // Endpoints are stored channel by channel, followed by the parity bits that extend every channel of an
+            // endpoint, or of both endpoints of a subset when they're shared.
+            size_t endpointCount = mode.subsets * 2;
+            std::array<std::array<uint32_t, 4>, 6> endpoints = {};
+            for (size_t c = 0; c < 4; ++c) {
+                for (size_t e = 0; e < endpointCount; ++e) {
+                    endpoints[e][c] = reader.read(c < 3 ? mode.colorBits : mode.alphaBits);
+                }
+            }
+
+            std::array<uint32_t, 6> parities = {};
+            if (mode.endpointParity) {
+                for (size_t e = 0; e < endpointCount; ++e) {
+                    parities[e] = reader.read(1);
+                }
+            }
+            if (mode.sharedParity) {
+                for (size_t s = 0; s < mode.subsets; ++s) {
+                    parities[s * 2] = parities[s * 2 + 1] = reader.read(1);
+                }
+            }
+
+            for (size_t e = 0; e < endpointCount; ++e) {
+                for (size_t c = 0; c < 4; ++c) {
+                    uint32_t bits = c < 3 ? mode.colorBits : mode.alphaBits;
+                    if (bits == 0) {
+                        endpoints[e][c] = 255;
+                        continue;
+                    }
+                    uint32_t value = endpoints[e][c];
+                    if (mode.endpointParity || mode.sharedParity) {
+                        value = value << 1 | parities[e];
+                        bits++;
+                    }
+                    value <<= 8 - bits;
+                    endpoints[e][c] = value | value >> bits;
+                }
+            }
+
+            auto getSubset = [&](size_t texel) -> uint32_t {
+                switch (mode.subsets) {
+                case 2:
+                    return (bc7Partitions2[partition] >> (2 * texel)) & 3;
+                case 3:
+                    return (bc7Partitions3[partition] >> (2 * texel)) & 3;
+                default:
+                    return 0;
+                }
+            };
+            auto isAnchor = [&](size_t texel) -> bool {
+                switch (mode.subsets) {
+                case 2:
+                    return texel == 0 || texel == bc7Anchors2[partition];
+                case 3:
+                    return texel == 0 || texel == bc7Anchors3Second[partition] || texel == bc7Anchors3Third[partition];
+                default:
+                    return texel == 0;
+                }
+            };
+
+            std::array<uint32_t, 16> indices = {};
+            for (size_t i = 0; i < 16; ++i) {
+                indices[i] = reader.read(isAnchor(i) ? mode.indexBits - 1 : mode.indexBits);
+            }
+            std::array<uint32_t, 16> secondaryIndices = {};
+            if (mode.secondaryIndexBits > 0) {
+                for (size_t i = 0; i < 16; ++i) {
+                    secondaryIndices[i] = reader.read(i == 0 ? mode.secondaryIndexBits - 1 : mode.secondaryIndexBits);
+                }
+            }
+
+            // Modes 4 and 5 interpolate alpha with the secondary indices, or the other way around in mode 4 when the
+            // index selection bit is set, and can rotate alpha into one of the color channels.
+            for (size_t i = 0; i < 16; ++i) {
+                uint32_t subset = getSubset(i);
+                const std::array<uint32_t, 4>& low = endpoints[subset * 2];
+                const std::array<uint32_t, 4>& high = endpoints[subset * 2 + 1];
+
+                uint32_t colorBits = mode.indexBits;
+                uint32_t colorIndex = indices[i];
+                uint32_t alphaBits = mode.indexBits;
+                uint32_t alphaIndex = indices[i];
+                if (mode.secondaryIndexBits > 0) {
+                    alphaBits = mode.secondaryIndexBits;
+                    alphaIndex = secondaryIndices[i];
+                    if (indexSelection != 0) {
+                        std::swap(colorBits, alphaBits);
+                        std::swap(colorIndex, alphaIndex);
+                    }
+                }
+
+                for (size_t c = 0; c < 4; ++c) {
+                    uint32_t weight = c < 3 ? getBc7Weight(colorBits, colorIndex) : getBc7Weight(alphaBits, alphaIndex);
+                    block[i][c] = static_cast<uint8_t>(((64 - weight) * low[c] + weight * high[c] + 32) >> 6);
+                }
+                if (rotation != 0) {
+                    std::swap(block[i][3], block[i][rotation - 1]);
+                }
+            }
+        }
+
+        auto decodeBlock(const uint8_t* source, vk::Format format, Block& block) -> void {
+            switch (format) {
+            case vk::Format::eBc1RgbUnormBlock:
+            case vk::Format::eBc1RgbSrgbBlock:
+                decodeColor(source, false, false, block);
+                break;
+            case vk::Format::eBc1RgbaUnormBlock:
+            case vk::Format::eBc1RgbaSrgbBlock:
+                decodeColor(source, false, true, block);
+                break;
+            case vk::Format::eBc3UnormBlock:
+            case vk::Format::eBc3SrgbBlock:
+                decodeColor(source + 8, true, false, block);
+                decodeChannel(source, 3, block);
+                break;
+            case vk::Format::eBc4UnormBlock:
+                block.fill({ 0, 0, 0, 255 });
+                decodeChannel(source, 0, block);
+                break;
+            case vk::Format::eBc5UnormBlock:
+                block.fill({ 0, 0, 0, 255 });
+                decodeChannel(source, 0, block);
+                decodeChannel(source + 8, 1, block);
+                break;
+            case vk::Format::eBc7UnormBlock:
+            case vk::Format::eBc7SrgbBlock:
+                decodeBc7(source, block);
+                break;
+            default:
+                throw std::runtime_error(fmt::format("Can't decompress {} textures on the CPU", vk::to_string(format)));
+            }
+        }
+    }
+
+    auto getBlockSize(vk::Format format) -> size_t {
+        switch (format) {
+        case vk::Format::eBc1RgbUnormBlock:
+        case vk::Format::eBc1RgbSrgbBlock:
+        case vk::Format::eBc1RgbaUnormBlock:
+        case vk::Format::eBc1RgbaSrgbBlock:
+        case vk::Format::eBc4UnormBlock:
+            return 8;
+        case vk::Format::eBc3UnormBlock:
+        case vk::Format::eBc3SrgbBlock:
+        case vk::Format::eBc5UnormBlock:
+        case vk::Format::eBc7UnormBlock:
+        case vk::Format::eBc7SrgbBlock:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    auto getDecompressedFormat(vk::Format format) -> vk::Format {
+        if (getBlockSize(format) == 0) {
+            throw std::runtime_error(fmt::format("Can't decompress {} textures on the CPU", vk::to_string(format)));
+        }
+        return isSrgb(format) ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+    }
+
+    // Edge blocks of sizes that aren't a multiple of four repeat the last row and column.
+    auto compress(parallel::ThreadPool& pool, std::span<const uint8_t> pixels, glm::uvec2 size, vk::Format format) -> std::vector<uint8_t> {
+        size_t blockSize = getBlockSize(format);
+        if (blockSize == 0) {
+            throw std::runtime_error(fmt::format("Can't compress textures to {}", vk::to_string(format)));
+        }
+
+        glm::uvec2 blocks = (size + 3u) / 4u;
+        std::vector<uint8_t> result(static_cast<size_t>(blocks.x) * blocks.y * blockSize);
+
+        pool.run(blocks.y, [&](size_t row) {
+            Block block;
+            for (uint32_t column = 0; column < blocks.x; ++column) {
+                for (uint32_t y = 0; y < 4; ++y) {
+                    for (uint32_t x = 0; x < 4; ++x) {
+                        size_t pixelX = std::min<size_t>(column * 4 + x, size.x - 1);
+                        size_t pixelY = std::min<size_t>(row * 4 + y, size.y - 1);
+                        memcpy(block[y * 4 + x].data(), pixels.data() + (pixelY * size.x + pixelX) * 4, 4);
+                    }
+                }
+                encodeBlock(block, format, result.data() + (row * blocks.x + column) * blockSize);
+            }
+        });
+
+        return result;
+    }
+
+    auto decompress(std::span<const uint8_t> blocks, glm::uvec2 size, vk::Format format) -> std::vector<uint8_t> {
+        size_t blockSize = getBlockSize(format);
+        glm::uvec2 blockCount = (size + 3u) / 4u;
+        if (blockSize == 0 || blocks.size() < static_cast<size_t>(blockCount.x) * blockCount.y * blockSize) {
+            throw std::runtime_error(fmt::format("Can't decompress {} textures on the CPU", vk::to_string(format)));
+        }
+
+        std::vector<uint8_t> pixels(static_cast<size_t>(size.x) * size.y * 4);
+        Block block;
+        for (uint32_t row = 0; row < blockCount.y; ++row) {
+            for (uint32_t column = 0; column < blockCount.x; ++column) {
+                decodeBlock(blocks.data() + (static_cast<size_t>(row) * blockCount.x + column) * blockSize, format, block);
+                for (uint32_t y = 0; y < 4 && row * 4 + y < size.y; ++y) {
+                    for (uint32_t x = 0; x < 4 && column * 4 + x < size.x; ++x) {
+                        memcpy(pixels.data() + ((static_cast<size_t>(row) * 4 + y) * size.x + column * 4 + x) * 4, block[y * 4 + x].data(), 4);
+                    }
+                }
+            }
+        }
+        return pixels;
+    }
+
+    auto compress(parallel::ThreadPool& pool, const data::Texture& texture, vk::Format format) -> data::Texture {
+        if (texture.getFormat() != vk::Format::eR8G8B8A8Srgb && texture.getFormat() != vk::Format::eR8G8B8A8Unorm) {
+            throw std::runtime_error(fmt::format("Can't compress {} textures", vk::to_string(texture.getFormat())));
+        }
+
+        std::vector<uint8_t> blocks;
+        std::vector<data::TextureLevel> levels;
+        for (uint32_t level = 0; level < texture.getLevels().size(); ++level) {
+            const data::TextureLevel& source = texture.getLevels()[level];
+            std::vector<uint8_t> compressed = compress(pool, std::span<const uint8_t>(texture.getPixels() + source.offset, source.size), glm::uvec2(texture.getLevelDimentions(level)), format);
+            levels.push_back({ blocks.size(), compressed.size() });
+            blocks.insert(blocks.end(), compressed.begin(), compressed.end());
+        }
+
+        return data::Texture(format, texture.getDimentions(), std::move(blocks), std::move(levels));
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "data.h"
+#include "parallel.h"
+
+namespace vkr::bc {
+    // Bytes per 4x4 block, or 0 when the format isn't one of the BC formats handled here.
+    auto getBlockSize(vk::Format format) -> size_t;
+    auto getDecompressedFormat(vk::Format format) -> vk::Format;
+
+    auto compress(parallel::ThreadPool& pool, std::span<const uint8_t> pixels, glm::uvec2 size, vk::Format format) -> std::vector<uint8_t>;
+    auto decompress(std::span<const uint8_t> blocks, glm::uvec2 size, vk::Format format) -> std::vector<uint8_t>;
+
+    auto compress(parallel::ThreadPool& pool, const data::Texture& texture, vk::Format format) -> data::Texture;
+}
@@ -0,0 +1,384 @@
+#include "bench.h"
+
+namespace vkr::bench {
+    auto parseOptions(std::span<char*> arguments) -> Options {
+        Options options;
+
+        for (size_t i = 0; i < arguments.size(); ++i) {
+            std::string_view argument = arguments[i];
+
+            auto value = [&]() -> std::string {
+                if (i + 1 >= arguments.size()) {
+                    throw std::runtime_error(fmt::format("Missing value for {}", argument));
+                }
+                return arguments[++i];
+            };
+
+            if (argument == "--scene") {
+                options.scene = value();
+            }
+            else if (argument == "--count") {
+                options.count = std::stoull(value());
+            }
+            else if (argument == "--frames") {
+                options.frames = std::stoull(value());
+            }
+            else if (argument == "--warmup") {
+                options.warmup = std::stoull(value());
+            }
+            else if (argument == "--device") {
+                options.device = std::stoull(value());
+            }
+            else if (argument == "--timestep") {
+                options.timestep = std::stof(value());
+            }
+            else if (argument == "--lod-threshold") {
+                options.lodThreshold = std::stof(value());
+            }
+            else if (argument == "--mips") {
+                options.mips = value();
+                if (options.mips != "blit" && options.mips != "compute") {
+                    throw std::runtime_error(fmt::format("Unknown mip generator {}, expected blit or compute", options.mips));
+                }
+            }
+            else if (argument == "--textures") {
+                options.textures = std::max<size_t>(std::stoull(value()), 1);
+            }
+            else if (argument == "--draw-path") {
+                options.drawPath = value();
+                if (options.drawPath != "gpu" && options.drawPath != "cpu") {
+                    throw std::runtime_error(fmt::format("Unknown draw path {}, expected gpu or cpu", options.drawPath));
+                }
+            }
+            else if (argument == "--threads") {
+                options.threads = std::max<size_t>(std::stoull(value()), 1);
+            }
+            else if (argument == "--size") {
+                std::string size = value();
+                size_t separator = size.find('x');
+                if (separator == std::string::npos) {
+                    throw std::runtime_error(fmt::format("Size must look like 1280x720, got {}", size));
+                }
+                options.size = glm::ivec2(std::stoi(size.substr(0, separator)), std::stoi(size.substr(separator + 1)));
+            }
+            else if (argument == "--window") {
+                options.headless = false;
+            }
+            else if (argument == "--output") {
+                options.output = value();
+            }
+            else {
+                throw std::runtime_error(fmt::format("Unknown benchmark option {}", argument));
+            }
+        }
+
+        // The lod scene is the 10k orange field LOD selection is measured on; compare runs with --lod-threshold 0.
+        if (options.count == 0) {
+            options.count = options.scene == "lod" ? 10000 : options.scene == "materials" || options.scene == "draws" ? 1024 : 64;
+        }
+
+        return options;
+    }
+
+    auto summarize(std::vector<double> values) -> Summary {
+        Summary summary;
+        if (values.empty()) {
+            return summary;
+        }
+
+        std::sort(values.begin(), values.end());
+
+        auto percentile = [&](double p) {
+            auto rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(values.size())));
+            return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+        };
+
+        summary.mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+        summary.p50 = percentile(50.0);
+        summary.p95 = percentile(95.0);
+        summary.p99 = percentile(99.0);
+        return summary;
+    }
+
+    auto makeCube() -> data::Model {
+        data::Model model;
+
+        std::array<glm::vec3, 6> normals = {
+            glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+            glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+            glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+        };
+
+        for (const glm::vec3& normal : normals) {
+            glm::vec3 tangent = normal.x != 0.0f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+            glm::vec3 bitangent = glm::cross(normal, tangent);
+            auto first = static_cast<uint32_t>(model.vertices.size());
+
+            for (glm::vec2 corner : { glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f), glm::vec2(1.0f, 1.0f), glm::vec2(-1.0f, 1.0f) }) {
+                data::Vertex vertex;
+                vertex.position = (normal + tangent * corner.x + bitangent * corner.y) * 0.5f;
+                vertex.color = glm::abs(normal);
+                vertex.textureCoordinates = corner * 0.5f + 0.5f;
+                model.vertices.push_back(vertex);
+            }
+
+            for (uint32_t index : { 0u, 1u, 2u, 2u, 3u, 0u }) {
+                model.indices.push_back(first + index);
+            }
+        }
+
+        return model;
+    }
+
+    // Procedural stand-in for a render target or a material: an sRGB checkerboard with a gradient, so every level
+    // differs.
+    auto makeCheckerTexture(int size, glm::u8vec3 color) -> data::Texture {
+        std::vector<uint8_t> pixels(static_cast<size_t>(size) * static_cast<size_t>(size) * 4);
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                uint8_t* pixel = &pixels[(static_cast<size_t>(y) * static_cast<size_t>(size) + static_cast<size_t>(x)) * 4];
+                bool checker = ((x / 32) + (y / 32)) % 2 == 0;
+                pixel[0] = checker ? color.r : static_cast<uint8_t>(x * 255 / size);
+                pixel[1] = checker ? color.g : static_cast<uint8_t>(y * 255 / size);
+                pixel[2] = checker ? color.b : 64;
+                pixel[3] = 255;
+            }
+        }
+
+        std::vector<data::TextureLevel> levels = { { 0, pixels.size() } };
+        return data::Texture(vk::Format::eR8G8B8A8Srgb, glm::ivec2(size), std::move(pixels), std::move(levels));
+    }
+
+    Benchmark::Benchmark(const Options& options) : api::Renderer(rendererCreateInfo(options, this)), options(options) {
+        samples.resize(options.warmup + options.frames);
+        buildScene();
+    }
+
+    auto Benchmark::rendererCreateInfo(const Options& options, Benchmark* benchmark) -> api::RendererCreateInfo {
+        api::RendererCreateInfo info;
+        info.headless = options.headless;
+        info.lodErrorThreshold = options.lodThreshold;
+        info.mipGenerator = options.mips == "blit" ? api::MipGenerator::eBlit : api::MipGenerator::eCompute;
+        info.drawPath = options.drawPath == "cpu" ? api::DrawPath::eCpuRecording : api::DrawPath::eGpuCulling;
+        info.recordingThreads = options.threads;
+        info.deviceSelector = [device = options.device](std::vector<vk::PhysicalDeviceProperties> properties) {
+            if (device >= properties.size()) {
+                throw std::runtime_error(fmt::format("Device {} does not exist, {} available", device, properties.size()));
+            }
+            return device;
+        };
+        info.onGpuTime = [benchmark](uint64_t frame, double milliseconds) {
+            if (frame != 0 && frame <= benchmark->samples.size()) {
+                benchmark->samples[frame - 1].gpuMilliseconds = milliseconds;
+            }
+        };
+        info.windowCreateInfo.size = options.size;
+        info.windowCreateInfo.title = "Benchmark";
+        return info;
+    }
+
+    auto Benchmark::buildScene() -> void {
+        std::vector<data::Model> models;
+        if (options.scene == "rooms") {
+            models.emplace_back("models/room.obj");
+        }
+        else if (options.scene == "oranges" || options.scene == "lod") {
+            models.emplace_back("models/orange.obj");
+        }
+        else if (options.scene == "mixed") {
+            models.emplace_back("models/room.obj");
+            models.emplace_back("models/orange.obj");
+        }
+        else if (options.scene == "grid" || options.scene == "mipmaps" || options.scene == "materials" || options.scene == "draws") {
+            models.push_back(makeCube());
+        }
+        else {
+            throw std::runtime_error(fmt::format("Unknown benchmark scene {}", options.scene));
+        }
+
+        // The mipmaps scene rebuilds every level of a 4K dynamic texture each frame; compare runs with --mips.
+        // The materials scene gives every instance one of --textures textures, all drawn in the same pass.
+        std::vector<uint32_t> textures = { 0 };
+        if (options.scene == "mipmaps") {
+            setTexture(0, makeCheckerTexture(4096, glm::u8vec3(255)), true);
+        }
+        else if (options.scene == "materials") {
+            textures.clear();
+            for (size_t i = 0; i < options.textures; ++i) {
+                float hue = static_cast<float>(i) / static_cast<float>(options.textures);
+                glm::vec3 color = glm::clamp(glm::abs(glm::fract(glm::vec3(hue) + glm::vec3(1.0f, 2.0f / 3.0f, 1.0f / 3.0f)) * 6.0f - 3.0f) - 1.0f, 0.0f, 1.0f);
+                textures.push_back(pushTexture(makeCheckerTexture(64, glm::u8vec3(color * 255.0f))));
+            }
+        }
+        else if (options.scene != "grid" && options.scene != "draws") {
+            setTexture(0, data::Texture(options.scene == "oranges" || options.scene == "lod" ? "textures/orange.jpg" : "textures/room.png"));
+        }
+
+        float radius = 0.0f;
+        std::vector<uint32_t> meshes;
+        for (const data::Model& model : models) {
+            for (const data::Vertex& vertex : model.vertices) {
+                radius = std::max(radius, glm::length(vertex.position));
+            }
+            meshes.push_back(pushModel(model));
+        }
+
+        // The draws scene gives every instance a mesh of its own, so the CPU draw list grows with --count. Sweep
+        // --count and --threads with --draw-path cpu to measure how recording scales.
+        if (options.scene == "draws") {
+            while (meshes.size() < options.count) {
+                meshes.push_back(pushModel(models.front()));
+            }
+        }
+
+        auto side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(std::max<size_t>(options.count, 1)))));
+        float spacing = radius * 2.2f;
+
+        for (size_t i = 0; i < options.count; ++i) {
+            glm::vec3 position(static_cast<float>(i % side) * spacing, static_cast<float>(i / side) * spacing, 0.0f);
+            addInstance(meshes[i % meshes.size()], glm::translate(glm::mat4(1.0f), position), textures[i % textures.size()]);
+        }
+
+        center = glm::vec3(static_cast<float>(side - 1) * spacing * 0.5f, static_cast<float>(side - 1) * spacing * 0.5f, 0.0f);
+        extent = std::max(static_cast<float>(side) * spacing * 0.5f, radius);
+    }
+
+    auto Benchmark::placeCamera(float time) -> void {
+        constexpr size_t pointCount = 6;
+        std::array<glm::vec3, pointCount> points;
+        for (size_t i = 0; i < pointCount; ++i) {
+            float angle = glm::two_pi<float>() * static_cast<float>(i) / static_cast<float>(pointCount);
+            float height = extent * (i % 2 == 0 ? 0.4f : 0.8f);
+            points[i] = center + glm::vec3(std::cos(angle) * extent * 1.5f, std::sin(angle) * extent * 1.2f, height);
+        }
+
+        float duration = std::max(static_cast<float>(options.frames) * options.timestep, options.timestep);
+        float position = std::fmod(time / duration, 1.0f) * static_cast<float>(pointCount);
+        auto segment = static_cast<size_t>(position);
+        float t = position - static_cast<float>(segment);
+
+        glm::vec3 world = glm::catmullRom(
+            points[(segment + pointCount - 1) % pointCount],
+            points[segment % pointCount],
+            points[(segment + 1) % pointCount],
+            points[(segment + 2) % pointCount],
+            t
+        );
+
+        glm::vec3 direction = glm::normalize(center - world) * glm::vec3(-1.0f, 1.0f, -1.0f);
+
+        getCamera().position = world * glm::vec3(-1.0f, 1.0f, -1.0f);
+        getCamera().yaw = std::atan2(-direction.x, direction.y);
+        getCamera().pitch = -glm::half_pi<float>() + std::asin(direction.z);
+    }
+
+    auto Benchmark::run() -> void {
+        for (size_t i = 0; i < samples.size(); ++i) {
+            placeCamera(static_cast<float>(i) * options.timestep);
+
+            if (options.scene == "mipmaps") {
+                markTextureDirty(0);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            renderFrame();
+            auto end = std::chrono::steady_clock::now();
+
+            samples[i].cpuMilliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+            samples[i].triangles = getTriangleCount();
+            for (const memory::HeapStatistics& heap : getMemoryStatistics()) {
+                samples[i].allocatedBytes += heap.allocationBytes;
+                samples[i].reservedBytes += heap.blockBytes;
+            }
+        }
+        finishFrames();
+
+        writeReport();
+    }
+
+    auto Benchmark::writeReport() -> void {
+        std::span<const FrameSample> measured = std::span<const FrameSample>(samples).subspan(std::min(options.warmup, samples.size()));
+
+        std::vector<double> cpu;
+        std::vector<double> gpu;
+        std::vector<double> triangles;
+        for (const FrameSample& sample : measured) {
+            cpu.push_back(sample.cpuMilliseconds);
+            if (sample.gpuMilliseconds >= 0.0) {
+                gpu.push_back(sample.gpuMilliseconds);
+            }
+            triangles.push_back(static_cast<double>(sample.triangles));
+        }
+
+        Summary cpuSummary = summarize(cpu);
+        Summary gpuSummary = summarize(gpu);
+        Summary triangleSummary = summarize(triangles);
+
+        // Triangles submitted after LOD selection and before GPU culling, per second of GPU time when it was measured.
+        double frameMilliseconds = gpu.empty() ? cpuSummary.mean : gpuSummary.mean;
+        double trianglesPerSecond = frameMilliseconds > 0.0 ? triangleSummary.mean / (frameMilliseconds / 1e3) : 0.0;
+
+        auto formatSummary = [](const Summary& summary) {
+            return fmt::format("{{ \"mean\": {:.4f}, \"p50\": {:.4f}, \"p95\": {:.4f}, \"p99\": {:.4f} }}", summary.mean, summary.p50, summary.p95, summary.p99);
+        };
+
+        std::ofstream file(options.output);
+        if (!file) {
+            throw std::runtime_error(fmt::format("Couldn't open {}", options.output));
+        }
+
+        if (options.output.ends_with(".csv")) {
+            file << "frame,cpu_ms,gpu_ms,allocated_bytes,reserved_bytes,triangles\n";
+            for (size_t i = 0; i < measured.size(); ++i) {
+                file << fmt::format("{},{:.4f},{:.4f},{},{},{}\n", i, measured[i].cpuMilliseconds, measured[i].gpuMilliseconds, measured[i].allocatedBytes, measured[i].reservedBytes, measured[i].triangles);
+            }
+        }
+        else {
+            file << "{\n";
+            file << fmt::format("  \"scene\": \"{}\",\n", options.scene);
+            file << fmt::format("  \"count\": {},\n", options.count);
+            file << fmt::format("  \"frames\": {},\n", measured.size());
+            file << fmt::format("  \"timestep\": {},\n", options.timestep);
+            file << fmt::format("  \"size\": [{}, {}],\n", options.size.x, options.size.y);
+            file << fmt::format("  \"cpu\": {},\n", formatSummary(cpuSummary));
+            file << fmt::format("  \"gpu\": {},\n", formatSummary(gpuSummary));
+            file << fmt::format("  \"lod_threshold\": {},\n", options.lodThreshold);
+            file << fmt::format("  \"mips\": \"{}\",\n", options.mips);
+            file << fmt::format("  \"textures\": {},\n", options.textures);
+            file << fmt::format("  \"draw_path\": \"{}\",\n", options.drawPath);
+            file << fmt::format("  \"threads\": {},\n", options.threads);
+            file << fmt::format("  \"draws\": {},\n", getDrawCount());
+            file << fmt::format("  \"triangles\": {},\n", formatSummary(triangleSummary));
+            file << fmt::format("  \"triangles_per_second\": {:.0f},\n", trianglesPerSecond);
+            file << "  \"samples\": [\n";
+            for (size_t i = 0; i < measured.size(); ++i) {
+                file << fmt::format("    {{ \"cpu\": {:.4f}, \"gpu\": {:.4f}, \"allocated\": {}, \"reserved\": {}, \"triangles\": {} }}{}\n", measured[i].cpuMilliseconds, measured[i].gpuMilliseconds, measured[i].allocatedBytes, measured[i].reservedBytes, measured[i].triangles, i + 1 < measured.size() ? "," : "");
+            }
+            file << "  ]\n";
+            file << "}\n";
+        }
+
+        fmt::print("{} x{}: {} frames\n", options.scene, options.count, measured.size());
+        fmt::print("  cpu ms: mean {:.3f} p50 {:.3f} p95 {:.3f} p99 {:.3f}\n", cpuSummary.mean, cpuSummary.p50, cpuSummary.p95, cpuSummary.p99);
+        fmt::print("  gpu ms: mean {:.3f} p50 {:.3f} p95 {:.3f} p99 {:.3f}\n", gpuSummary.mean, gpuSummary.p50, gpuSummary.p95, gpuSummary.p99);
+        if (options.scene == "mipmaps") {
+            fmt::print("  mip generator: {}\n", options.mips);
+        }
+        if (options.drawPath == "cpu") {
+            fmt::print("  cpu recording: {} draws on {} threads\n", getDrawCount(), options.threads);
+        }
+        fmt::print("  triangles: mean {:.0f}, {:.1f} M/s at LOD threshold {} px\n", triangleSummary.mean, trianglesPerSecond / 1e6, options.lodThreshold);
+        fmt::print("  report written to {}\n", options.output);
+    }
+
+    auto run(std::span<char*> arguments) -> int {
+        try {
+            Benchmark(parseOptions(arguments)).run();
+        }
+        catch (const std::exception& e) {
+            spdlog::error(e.what());
+            return 1;
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "main.h"
+
+namespace vkr::bench {
+    struct Options {
+        std::string scene = "rooms";
+        size_t count = 0;
+        size_t frames = 600;
+        size_t warmup = 30;
+        size_t device = 0;
+        float timestep = 1.0f / 60.0f;
+        float lodThreshold = 1.0f;
+        std::string mips = "compute";
+        size_t textures = 256;
+        std::string drawPath = "gpu";
+        size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+        glm::ivec2 size = glm::ivec2(1280, 720);
+        bool headless = true;
+        std::string output = "bench.json";
+    };
+
+    struct FrameSample {
+        double cpuMilliseconds = 0.0;
+        double gpuMilliseconds = -1.0;
+        size_t triangles = 0;
+        vk::DeviceSize allocatedBytes = 0;
+        vk::DeviceSize reservedBytes = 0;
+    };
+
+    struct Summary {
+        double mean = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+    };
+
+    auto parseOptions(std::span<char*> arguments) -> Options;
+    auto summarize(std::vector<double> values) -> Summary;
+    auto makeCube() -> data::Model;
+    auto makeCheckerTexture(int size, glm::u8vec3 color) -> data::Texture;
+
+    class Benchmark : public api::Renderer {
+    public:
+        Benchmark(const Options& options);
+        auto run() -> void;
+    private:
+        static auto rendererCreateInfo(const Options& options, Benchmark* benchmark) -> api::RendererCreateInfo;
+        auto buildScene() -> void;
+        auto placeCamera(float time) -> void;
+        auto writeReport() -> void;
+        Options options;
+        std::vector<FrameSample> samples;
+        glm::vec3 center = glm::vec3(0.0f);
+        float extent = 1.0f;
+    };
+
+    auto run(std::span<char*> arguments) -> int;
+}
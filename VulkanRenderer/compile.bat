@@ -1,2 +1,5 @@
 %VULKAN_SDK%/Bin32/glslc.exe shaders/default.vert -o shaders/default.vert.spv
-%VULKAN_SDK%/Bin32/glslc.exe shaders/default.frag -o shaders/default.frag.spv
\ No newline at end of file
+%VULKAN_SDK%/Bin32/glslc.exe shaders/default.frag -o shaders/default.frag.spv
+%VULKAN_SDK%/Bin32/glslc.exe shaders/cull.comp -o shaders/cull.comp.spv
+%VULKAN_SDK%/Bin32/glslc.exe shaders/cluster.comp -o shaders/cluster.comp.spv
+%VULKAN_SDK%/Bin32/glslc.exe shaders/mipmap.comp -o shaders/mipmap.comp.spv
\ No newline at end of file
@@ -1,10 +1,55 @@
 #include "data.h"
+#include "bc.h"
+#include "ktx.h"
+#include "obj.h"
+#include "hash.h"
+#include "io.h"
+#include "meshlet.h"
+#include "mip.h"
+#include "optimize.h"
+#include "simplify.h"
 
 namespace vkr::data {
     auto Vertex::operator==(const Vertex& other) const -> bool {
         return position == other.position && color == other.color && textureCoordinates == other.textureCoordinates;
     }
 
+    auto Instance::getTransform() const -> glm::mat4 {
+        return glm::mat4(column0, column1, column2, column3);
+    }
+
+    auto Instance::setTransform(const glm::mat4& transform) -> void {
+        column0 = transform[0];
+        column1 = transform[1];
+        column2 = transform[2];
+        column3 = transform[3];
+    }
+
+    // Positions are stored relative to the bounding sphere, so the quantized mesh always fits the unit sphere.
+    auto Mesh::getDequantization() const -> glm::mat4 {
+        float scale = bounds.w > 0.0f ? bounds.w : 1.0f;
+        return glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(bounds)), glm::vec3(scale));
+    }
+
+    // Texture coordinates are stored relative to the mesh's range, so tiling coordinates outside [0, 1] survive the
+    // unorm encoding and the sampler can still repeat them.
+    auto Mesh::getTextureDequantization() const -> glm::vec4 {
+        return glm::vec4(glm::vec2(textureBounds), textureBounds.z > 0.0f ? textureBounds.z : 1.0f, textureBounds.w > 0.0f ? textureBounds.w : 1.0f);
+    }
+
+    auto Mesh::packVertex(const Vertex& vertex) const -> PackedVertex {
+        float scale = bounds.w > 0.0f ? 1.0f / bounds.w : 1.0f;
+        glm::vec3 position = (vertex.position - glm::vec3(bounds)) * scale;
+
+        glm::vec4 textureDequantization = getTextureDequantization();
+        glm::vec2 textureCoordinates = (vertex.textureCoordinates - glm::vec2(textureDequantization)) / glm::vec2(textureDequantization.z, textureDequantization.w);
+
+        PackedVertex packed;
+        packed.position = { pack::toSnorm16(position.x), pack::toSnorm16(position.y), pack::toSnorm16(position.z), 0 };
+        packed.textureCoordinates = { pack::toUnorm16(textureCoordinates.x), pack::toUnorm16(textureCoordinates.y) };
+        return packed;
+    }
+
     auto Camera::getDirection() -> glm::vec3 {
         return glm::rotateZ(glm::rotateX(glm::vec3(0.0f, 0.0f, 1.0f), pitch), yaw);
     }
@@ -17,38 +62,116 @@ namespace vkr::data {
         return glm::rotateZ(glm::vec3(1.0f, 0.0f, 0.0f), yaw);
     }
 
-    Texture::Texture() {
-        data = new uint8_t[4];
-        data[0] = 255;
-        data[1] = 255;
-        data[2] = 255;
-        data[3] = 255;
-        size = glm::ivec2(1, 1);
+    namespace {
+        constexpr std::string_view textureCacheKey = "VkrSource";
+
+        auto getCacheKey(const char* file) -> CacheKey {
+            io::file::Mapping mapping(file);
+            std::string_view data = mapping.getData();
+
+            CacheKey key;
+            key.size = data.size();
+            key.time = static_cast<int64_t>(std::filesystem::last_write_time(file).time_since_epoch().count());
+            key.hash = hash::hashBytes(data.data(), data.size());
+            return key;
+        }
     }
 
-    Texture::Texture(const char* file) {
-        int temp;
-        data = stb::stbi_load(file, &size.x, &size.y, &temp, stb::STBI_rgb_alpha);
-        if (!data) {
-            throw std::runtime_error(fmt::format("STB: Failed to load a texture {}", file));
+    Texture::Texture() : size(1, 1), pixels(4, 255), levels({ { 0, 4 } }) {}
+
+    // A transcoded <stem>.ktx2 that is at least as new as the image takes its place. Otherwise the image gets its mip
+    // chain built on the CPU once and cached as <file>.ktx2, keyed on the source like the model cache, so uploads only
+    // copy prebuilt levels.
+    Texture::Texture(const char* file, bool useCache) {
+        std::filesystem::path path(file);
+        if (path.extension() == ".ktx2") {
+            *this = ktx::read(file);
+            return;
+        }
+        if (!useCache) {
+            load(file);
+            return;
+        }
+
+        std::filesystem::path transcoded = std::filesystem::path(path).replace_extension(".ktx2");
+        std::error_code error;
+        if (std::filesystem::exists(transcoded, error) && std::filesystem::last_write_time(transcoded, error) >= std::filesystem::last_write_time(path, error) && !error) {
+            *this = ktx::read(transcoded.string().c_str());
+            return;
+        }
+
+        std::string cachePath = std::string(file) + ".ktx2";
+        CacheKey key = getCacheKey(file);
+        std::string source = fmt::format("{} {} {} {}", key.size, key.time, key.hash, mip::getFilterName(mip::defaultFilter));
+
+        if (readCache(cachePath, source)) {
+            return;
+        }
+
+        load(file);
+        *this = mip::buildMipChain(*this);
+        writeCache(cachePath, source);
+    }
+
+    Texture::Texture(vk::Format format, glm::ivec2 size, std::vector<uint8_t> pixels, std::vector<TextureLevel> levels) : size(size), format(format), pixels(std::move(pixels)), levels(std::move(levels)) {
+        for (const TextureLevel& level : this->levels) {
+            if (level.offset + level.size > this->pixels.size()) {
+                throw std::runtime_error("Texture level is out of bounds");
+            }
         }
     }
 
     Texture::Texture(Texture&& other) {
-        std::swap(size, other.size);
-        std::swap(data, other.data);
+        *this = std::move(other);
     }
 
     auto Texture::operator=(Texture&& other) -> void {
-        size = other.size;
-        data = other.data;
-        other.size = glm::ivec2(0, 0);
-        other.data = nullptr;
+        size = std::exchange(other.size, glm::ivec2(0, 0));
+        format = other.format;
+        pixels = std::move(other.pixels);
+        levels = std::move(other.levels);
+    }
+
+    Texture::~Texture() = default;
+
+    auto Texture::load(const char* file) -> void {
+        int temp;
+        stb::stbi_uc* data = stb::stbi_load(file, &size.x, &size.y, &temp, stb::STBI_rgb_alpha);
+        if (!data) {
+            throw std::runtime_error(fmt::format("STB: Failed to load a texture {}", file));
+        }
+        format = vk::Format::eR8G8B8A8Srgb;
+        pixels.assign(data, data + static_cast<size_t>(size.x) * static_cast<size_t>(size.y) * sizeof(uint32_t));
+        levels = { { 0, pixels.size() } };
+        stb::stbi_image_free(data);
     }
 
-    Texture::~Texture() {
-        if (data) {
-            stb::stbi_image_free(data);
+    auto Texture::readCache(const std::string& path, const std::string& source) -> bool {
+        if (!std::filesystem::exists(path)) {
+            return false;
+        }
+
+        try {
+            for (const ktx::KeyValue& entry : ktx::readKeyValues(path.c_str())) {
+                if (entry.key == textureCacheKey && entry.value == source) {
+                    *this = ktx::read(path.c_str());
+                    return true;
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            spdlog::warn("Ignoring the texture cache {}: {}", path, e.what());
+        }
+        return false;
+    }
+
+    auto Texture::writeCache(const std::string& path, const std::string& source) const -> void {
+        try {
+            std::array<ktx::KeyValue, 1> keyValues = { ktx::KeyValue{ std::string(textureCacheKey), source } };
+            ktx::write(path.c_str(), *this, keyValues);
+        }
+        catch (const std::exception& e) {
+            spdlog::warn("Couldn't write the texture cache {}: {}", path, e.what());
         }
     }
 
@@ -56,50 +179,368 @@ namespace vkr::data {
         return size;
     }
 
+    auto Texture::getLevelDimentions(uint32_t level) const -> glm::ivec2 {
+        return glm::max(glm::ivec2(size.x >> level, size.y >> level), glm::ivec2(1));
+    }
+
     auto Texture::getPixels() const -> const uint8_t* {
-        return data;
+        return pixels.data();
     }
 
     auto Texture::getSize() const -> size_t {
-        return static_cast<size_t>(size.x) * static_cast<size_t>(size.y) * sizeof(uint32_t);
+        return pixels.size();
+    }
+
+    auto Texture::getFormat() const -> vk::Format {
+        return format;
+    }
+
+    auto Texture::getLevels() const -> std::span<const TextureLevel> {
+        return levels;
     }
 
-    Model::Model(const char* file) {
-        tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string warn, err;
+    // The RGBA8 fallback for devices that can't sample the texture's format. Every level is decoded, so the mip chain
+    // is kept.
+    auto Texture::decompress() const -> Texture {
+        vk::Format decompressedFormat = bc::getDecompressedFormat(format);
 
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, file)) {
-            throw std::runtime_error(fmt::format("TinyObj: {}; {};", warn, err));
+        std::vector<uint8_t> decompressed;
+        std::vector<TextureLevel> decompressedLevels;
+        for (uint32_t level = 0; level < levels.size(); ++level) {
+            std::vector<uint8_t> decoded = bc::decompress(std::span<const uint8_t>(pixels.data() + levels[level].offset, levels[level].size), glm::uvec2(getLevelDimentions(level)), format);
+            decompressedLevels.push_back({ decompressed.size(), decoded.size() });
+            decompressed.insert(decompressed.end(), decoded.begin(), decoded.end());
         }
 
-        std::unordered_map<data::Vertex, uint32_t> uniqueVertices;
+        return Texture(decompressedFormat, size, std::move(decompressed), std::move(decompressedLevels));
+    }
 
-        for (const auto& shape : shapes) {
-            for (const auto& index : shape.mesh.indices) {
-                data::Vertex vertex;
+    namespace {
+        constexpr std::array<char, 8> modelCacheMagic = { 'V', 'K', 'R', 'M', 'E', 'S', 'H', '\0' };
+        constexpr uint32_t modelCacheVersion = 4;
+        constexpr uint64_t modelCacheAlignment = 64;
 
-                vertex.position = {
-                    attrib.vertices[static_cast<size_t>(index.vertex_index) * 3 + 0],
-                    attrib.vertices[static_cast<size_t>(index.vertex_index) * 3 + 1],
-                    attrib.vertices[static_cast<size_t>(index.vertex_index) * 3 + 2]
-                };
+        struct ModelCacheHeader {
+            std::array<char, 8> magic = modelCacheMagic;
+            uint32_t version = modelCacheVersion;
+            uint32_t vertexStride = sizeof(Vertex);
+            CacheKey key;
+            uint64_t vertexCount = 0;
+            uint64_t vertexOffset = 0;
+            uint64_t indexCount = 0;
+            uint64_t indexOffset = 0;
+            LodOptions lodOptions;
+            uint32_t lodCount = 0;
+            uint64_t lodOffset = 0;
+        };
 
-                vertex.textureCoordinates = {
-                    attrib.texcoords[static_cast<size_t>(index.texcoord_index) * 2 + 0],
-                    1.0f - attrib.texcoords[static_cast<size_t>(index.texcoord_index) * 2 + 1]
-                };
+        struct ModelCacheLod {
+            uint64_t indexCount = 0;
+            uint64_t indexOffset = 0;
+            float error = 0.0f;
+            uint32_t padding = 0;
+        };
 
-                vertex.color = { 1.0f, 1.0f, 1.0f };
+        auto alignOffset(uint64_t offset) -> uint64_t {
+            return (offset + modelCacheAlignment - 1) / modelCacheAlignment * modelCacheAlignment;
+        }
+    }
 
-                if (uniqueVertices.count(vertex) == 0) {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                    vertices.push_back(vertex);
-                }
+    Model::Model(const char* file, bool useCache, const LodOptions& lodOptions) {
+        if (!useCache) {
+            parse(file, lodOptions);
+            return;
+        }
+
+        std::string path = std::string(file) + ".vkrmesh";
+        CacheKey key = getCacheKey(file);
+
+        if (readCache(path, key, lodOptions)) {
+            return;
+        }
+
+        parse(file, lodOptions);
+        writeCache(path, key, lodOptions);
+    }
+
+    auto Model::parse(const char* file, const LodOptions& lodOptions) -> void {
+        obj::Mesh mesh = obj::load(file);
+
+        static_assert(sizeof(data::Vertex) == sizeof(float) * 8, "Vertices are deduplicated by their bytes");
+        hash::Table<data::Vertex, uint32_t> uniqueVertices(mesh.corners.size());
+
+        vertices.reserve(mesh.positions.size());
+        indices.reserve(mesh.corners.size());
+
+        for (const obj::Corner& corner : mesh.corners) {
+            data::Vertex vertex;
+
+            vertex.position = mesh.positions[corner.position];
+
+            if (corner.texcoord) {
+                const glm::vec2& texcoord = mesh.texcoords[*corner.texcoord];
+                vertex.textureCoordinates = { texcoord.x, 1.0f - texcoord.y };
+            }
+
+            vertex.color = { 1.0f, 1.0f, 1.0f };
+
+            auto [index, inserted] = uniqueVertices.tryEmplace(vertex, static_cast<uint32_t>(vertices.size()));
+            if (inserted) {
+                vertices.push_back(vertex);
+            }
+
+            indices.push_back(index);
+        }
 
-                indices.push_back(uniqueVertices[vertex]);
+        optimize::Report report = optimize::optimizeModel(*this);
+        spdlog::info("Optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", file, report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr);
+
+        buildLods(lodOptions);
+        for (size_t i = 0; i < lods.size(); ++i) {
+            spdlog::info("LOD {} of {}: {} triangles, error {:.5f}", i + 1, file, lods[i].indices.size() / 3, lods[i].error);
+        }
+    }
+
+    // Every level is simplified from the one before it, so errors accumulate down the chain. The levels share the
+    // model's vertices and stop once a pass can no longer remove a meaningful share of the triangles.
+    auto Model::buildLods(const LodOptions& options) -> void {
+        lods.clear();
+        lods.reserve(options.maxLevels);
+
+        float maxError = options.maxError * getBounds().w;
+        std::span<const uint32_t> source = indices;
+        float error = 0.0f;
+
+        for (uint32_t level = 0; level < options.maxLevels && error < maxError; ++level) {
+            auto target = static_cast<size_t>(static_cast<float>(source.size() / 3) * options.reduction) * 3;
+            simplify::Result result = simplify::simplify(source, vertices, target, maxError - error);
+            if (result.indices.empty() || result.indices.size() * 10 > source.size() * 9) {
+                break;
+            }
+
+            optimize::optimizeVertexCache(result.indices, vertices.size());
+
+            error += result.error;
+            Lod& lod = lods.emplace_back();
+            lod.indices = std::move(result.indices);
+            lod.error = error;
+            source = lod.indices;
+        }
+    }
+
+    auto Model::readCache(const std::string& path, const CacheKey& key, const LodOptions& lodOptions) -> bool {
+        if (!std::filesystem::exists(path)) {
+            return false;
+        }
+
+        io::file::Mapping mapping(path.c_str());
+        std::string_view data = mapping.getData();
+
+        ModelCacheHeader header;
+        if (data.size() < sizeof(header)) {
+            return false;
+        }
+        memcpy(&header, data.data(), sizeof(header));
+
+        if (header.magic != modelCacheMagic || header.version != modelCacheVersion || header.vertexStride != sizeof(Vertex)) {
+            return false;
+        }
+        if (header.key.size != key.size || header.key.time != key.time || header.key.hash != key.hash) {
+            return false;
+        }
+        if (header.lodOptions.maxLevels != lodOptions.maxLevels || header.lodOptions.reduction != lodOptions.reduction || header.lodOptions.maxError != lodOptions.maxError) {
+            return false;
+        }
+
+        uint64_t vertexBytes = header.vertexCount * sizeof(Vertex);
+        uint64_t indexBytes = header.indexCount * sizeof(uint32_t);
+        uint64_t lodBytes = header.lodCount * sizeof(ModelCacheLod);
+        if (header.vertexOffset + vertexBytes > data.size() || header.indexOffset + indexBytes > data.size() || header.lodOffset + lodBytes > data.size()) {
+            return false;
+        }
+
+        std::vector<ModelCacheLod> lodTable(header.lodCount);
+        memcpy(lodTable.data(), data.data() + header.lodOffset, static_cast<size_t>(lodBytes));
+        for (const ModelCacheLod& entry : lodTable) {
+            if (entry.indexOffset + entry.indexCount * sizeof(uint32_t) > data.size()) {
+                return false;
+            }
+        }
+
+        vertices.resize(static_cast<size_t>(header.vertexCount));
+        indices.resize(static_cast<size_t>(header.indexCount));
+        memcpy(vertices.data(), data.data() + header.vertexOffset, static_cast<size_t>(vertexBytes));
+        memcpy(indices.data(), data.data() + header.indexOffset, static_cast<size_t>(indexBytes));
+
+        lods.resize(lodTable.size());
+        for (size_t i = 0; i < lodTable.size(); ++i) {
+            lods[i].indices.resize(static_cast<size_t>(lodTable[i].indexCount));
+            lods[i].error = lodTable[i].error;
+            memcpy(lods[i].indices.data(), data.data() + lodTable[i].indexOffset, static_cast<size_t>(lodTable[i].indexCount * sizeof(uint32_t)));
+        }
+        return true;
+    }
+
+    auto Model::writeCache(const std::string& path, const CacheKey& key, const LodOptions& lodOptions) const -> void {
+        ModelCacheHeader header;
+        header.key = key;
+        header.vertexCount = vertices.size();
+        header.vertexOffset = alignOffset(sizeof(header));
+        header.indexCount = indices.size();
+        header.indexOffset = alignOffset(header.vertexOffset + vertices.size() * sizeof(Vertex));
+        header.lodOptions = lodOptions;
+        header.lodCount = static_cast<uint32_t>(lods.size());
+        header.lodOffset = alignOffset(header.indexOffset + indices.size() * sizeof(uint32_t));
+
+        std::vector<ModelCacheLod> lodTable(lods.size());
+        uint64_t offset = alignOffset(header.lodOffset + lodTable.size() * sizeof(ModelCacheLod));
+        for (size_t i = 0; i < lods.size(); ++i) {
+            lodTable[i].indexCount = lods[i].indices.size();
+            lodTable[i].indexOffset = offset;
+            lodTable[i].error = lods[i].error;
+            offset = alignOffset(offset + lods[i].indices.size() * sizeof(uint32_t));
+        }
+
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+            if (!stream) {
+                spdlog::warn("Couldn't write the model cache {}", path);
+                return;
+            }
+
+            auto pad = [&](uint64_t offset) {
+                static constexpr std::array<char, modelCacheAlignment> zeros = {};
+                stream.write(zeros.data(), static_cast<std::streamsize>(offset - static_cast<uint64_t>(stream.tellp())));
+            };
+
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            pad(header.vertexOffset);
+            stream.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertices.size() * sizeof(Vertex)));
+            pad(header.indexOffset);
+            stream.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indices.size() * sizeof(uint32_t)));
+            pad(header.lodOffset);
+            stream.write(reinterpret_cast<const char*>(lodTable.data()), static_cast<std::streamsize>(lodTable.size() * sizeof(ModelCacheLod)));
+            for (size_t i = 0; i < lods.size(); ++i) {
+                pad(lodTable[i].indexOffset);
+                stream.write(reinterpret_cast<const char*>(lods[i].indices.data()), static_cast<std::streamsize>(lods[i].indices.size() * sizeof(uint32_t)));
+            }
+
+            if (!stream) {
+                spdlog::warn("Couldn't write the model cache {}", path);
+                return;
             }
         }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            spdlog::warn("Couldn't write the model cache {}: {}", path, error.message());
+            std::filesystem::remove(temporary, error);
+        }
+    }
+
+    auto Model::getBounds() const -> glm::vec4 {
+        if (vertices.empty()) {
+            return glm::vec4(0.0f);
+        }
+
+        glm::vec3 minimum = vertices.front().position;
+        glm::vec3 maximum = vertices.front().position;
+        for (const data::Vertex& vertex : vertices) {
+            minimum = glm::min(minimum, vertex.position);
+            maximum = glm::max(maximum, vertex.position);
+        }
+
+        glm::vec3 center = (minimum + maximum) * 0.5f;
+        float radius = 0.0f;
+        for (const data::Vertex& vertex : vertices) {
+            radius = std::max(radius, glm::distance(center, vertex.position));
+        }
+        return glm::vec4(center, radius);
+    }
+
+    auto Model::getTextureBounds() const -> glm::vec4 {
+        if (vertices.empty()) {
+            return glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+        }
+
+        glm::vec2 minimum = vertices.front().textureCoordinates;
+        glm::vec2 maximum = vertices.front().textureCoordinates;
+        for (const data::Vertex& vertex : vertices) {
+            minimum = glm::min(minimum, vertex.textureCoordinates);
+            maximum = glm::max(maximum, vertex.textureCoordinates);
+        }
+        return glm::vec4(minimum, maximum - minimum);
+    }
+
+    // Every level of the model's LOD chain becomes its own mesh, consecutive with the full resolution one and sharing its
+    // vertices, so an instance switches level by moving to a neighbouring mesh.
+    auto appendModel(ModelStore& store, const Model& data) -> uint32_t {
+        auto first = static_cast<uint32_t>(store.meshes.size());
+        auto lodCount = static_cast<uint32_t>(data.lods.size() + 1);
+        glm::vec4 bounds = data.getBounds();
+        glm::vec4 textureBounds = data.getTextureBounds();
+
+        // Meshlet bounds are uploaded in the mesh's quantized space, the same space the instance transforms expect.
+        float quantizationScale = bounds.w > 0.0f ? 1.0f / bounds.w : 1.0f;
+
+        for (uint32_t lod = 0; lod < lodCount; ++lod) {
+            std::span<const uint32_t> indices = lod == 0 ? std::span<const uint32_t>(data.indices) : std::span<const uint32_t>(data.lods[lod - 1].indices);
+
+            Mesh mesh;
+            mesh.firstIndex = static_cast<uint32_t>(store.model.indices.size());
+            mesh.indexCount = static_cast<uint32_t>(indices.size());
+            mesh.vertexOffset = static_cast<int32_t>(store.model.vertices.size());
+            mesh.vertexCount = static_cast<uint32_t>(data.vertices.size());
+            mesh.bounds = bounds;
+            mesh.textureBounds = textureBounds;
+            mesh.firstMeshlet = static_cast<uint32_t>(store.meshlets.size());
+            mesh.lodCount = lodCount - lod;
+            mesh.lodError = lod == 0 ? 0.0f : data.lods[lod - 1].error;
+
+            for (Meshlet meshlet : meshlet::buildMeshlets(indices, data.vertices)) {
+                meshlet.bounds = glm::vec4((glm::vec3(meshlet.bounds) - glm::vec3(bounds)) * quantizationScale, meshlet.bounds.w * quantizationScale);
+                store.meshlets.push_back(meshlet);
+            }
+            mesh.meshletCount = static_cast<uint32_t>(store.meshlets.size()) - mesh.firstMeshlet;
+
+            store.meshes.push_back(mesh);
+            store.model.indices.insert(store.model.indices.end(), indices.begin(), indices.end());
+        }
+
+        store.model.vertices.insert(store.model.vertices.end(), data.vertices.begin(), data.vertices.end());
+
+        // Indices are relative to each mesh's vertexOffset, so 16 bits suffice until one mesh needs more.
+        constexpr size_t maxUint16Vertices = size_t(1) << 16;
+        if (data.vertices.size() > maxUint16Vertices) {
+            store.indexType = vk::IndexType::eUint32;
+        }
+
+        return first;
+    }
+
+    auto packVertices(const ModelStore& store, size_t begin, size_t end, PackedVertex* destination) -> void {
+        auto mesh = std::upper_bound(store.meshes.begin(), store.meshes.end(), begin, [](size_t vertex, const Mesh& mesh) {
+            return vertex < static_cast<size_t>(mesh.vertexOffset);
+        }) - 1;
+
+        for (size_t i = begin; i < end; ++i) {
+            while (i >= static_cast<size_t>(mesh->vertexOffset) + mesh->vertexCount) {
+                ++mesh;
+            }
+            *destination++ = mesh->packVertex(store.model.vertices[i]);
+        }
+    }
+
+    auto packIndices(const ModelStore& store, size_t begin, size_t end, void* destination) -> void {
+        if (store.indexType == vk::IndexType::eUint16) {
+            std::transform(store.model.indices.begin() + static_cast<ptrdiff_t>(begin), store.model.indices.begin() + static_cast<ptrdiff_t>(end), static_cast<uint16_t*>(destination), [](uint32_t index) {
+                return static_cast<uint16_t>(index);
+            });
+        }
+        else {
+            memcpy(destination, store.model.indices.data() + begin, (end - begin) * sizeof(uint32_t));
+        }
     }
 }
\ No newline at end of file
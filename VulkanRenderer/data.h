@@ -1,4 +1,5 @@
 #pragma once
+#include "pack.h"
 
 namespace vkr::data {
     struct Vertex {
@@ -8,6 +9,62 @@ namespace vkr::data {
         auto operator==(const Vertex& other) const -> bool;
     };
 
+    struct PackedVertex {
+        pack::Snorm16x4 position;
+        pack::Unorm16x2 textureCoordinates;
+    };
+
+    struct Instance {
+        glm::vec4 column0 = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec4 column1 = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+        glm::vec4 column2 = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+        glm::vec4 column3 = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        // x is the texture; the rest keeps the stride a multiple of 16 for the culling shaders.
+        glm::u32vec4 material = glm::u32vec4(0);
+        // Offset and scale that take the mesh's quantized texture coordinates back to the model's.
+        glm::vec4 textureTransform = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+        auto getTransform() const -> glm::mat4;
+        auto setTransform(const glm::mat4& transform) -> void;
+    };
+
+    struct alignas(16) Mesh {
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        int32_t vertexOffset = 0;
+        uint32_t vertexCount = 0;
+        glm::vec4 bounds = glm::vec4(0.0f);
+        uint32_t firstMeshlet = 0;
+        uint32_t meshletCount = 0;
+        uint32_t lodCount = 1;
+        float lodError = 0.0f;
+        // xy is the smallest texture coordinate and zw the extent of the range.
+        glm::vec4 textureBounds = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+        auto getDequantization() const -> glm::mat4;
+        auto getTextureDequantization() const -> glm::vec4;
+        auto packVertex(const Vertex& vertex) const -> PackedVertex;
+    };
+
+    struct alignas(16) Meshlet {
+        glm::vec4 bounds = glm::vec4(0.0f);
+        glm::vec4 cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        uint32_t vertexCount = 0;
+    };
+
+    struct Culling {
+        std::array<glm::vec4, 6> planes = {};
+        glm::vec4 camera = glm::vec4(0.0f);
+        uint32_t instanceCount = 0;
+    };
+
+    struct Mipmap {
+        glm::ivec2 size = glm::ivec2(0);
+        uint32_t mipLevels = 0;
+        uint32_t workgroupCount = 0;
+        uint32_t srgb = 0;
+    };
+
     struct UBO {
         alignas(16) glm::mat4 model = glm::mat4(1.0f);
         alignas(16) glm::mat4 view = glm::mat4(1.0f);
@@ -25,35 +82,83 @@ namespace vkr::data {
         float yaw = 0.0f;
     };
 
+    struct CacheKey {
+        uint64_t size = 0;
+        int64_t time = 0;
+        uint64_t hash = 0;
+    };
+
+    struct TextureLevel {
+        size_t offset = 0;
+        size_t size = 0;
+    };
+
+    // Levels are stored largest first in one allocation. A texture with a single level gets its mipmaps built when it
+    // is uploaded.
     class Texture {
     public:
         Texture();
-        Texture(const char* file);
+        Texture(const char* file, bool useCache = true);
+        Texture(vk::Format format, glm::ivec2 size, std::vector<uint8_t> pixels, std::vector<TextureLevel> levels);
         Texture(const Texture&) = delete;
         Texture(Texture&& other);
         auto operator=(Texture&& other) -> void;
         ~Texture();
         auto getDimentions() const->glm::ivec2;
+        auto getLevelDimentions(uint32_t level) const -> glm::ivec2;
         auto getPixels() const -> const uint8_t*;
         auto getSize() const->size_t;
+        auto getFormat() const -> vk::Format;
+        auto getLevels() const -> std::span<const TextureLevel>;
+        auto decompress() const -> Texture;
     private:
+        auto load(const char* file) -> void;
+        auto readCache(const std::string& path, const std::string& source) -> bool;
+        auto writeCache(const std::string& path, const std::string& source) const -> void;
         glm::ivec2 size = glm::ivec2(0, 0);
-        stb::stbi_uc* data = nullptr;
+        vk::Format format = vk::Format::eR8G8B8A8Srgb;
+        std::vector<uint8_t> pixels;
+        std::vector<TextureLevel> levels;
+    };
+
+    // Each level keeps about reduction of the previous level's triangles; maxError is a fraction of the bounding radius.
+    struct LodOptions {
+        uint32_t maxLevels = 4;
+        float reduction = 0.5f;
+        float maxError = 0.05f;
+    };
+
+    struct Lod {
+        std::vector<uint32_t> indices;
+        float error = 0.0f;
     };
 
     class Model {
     public:
         Model() = default;
-        Model(const char* file);
+        Model(const char* file, bool useCache = true, const LodOptions& lodOptions = LodOptions());
+        auto getBounds() const -> glm::vec4;
+        auto getTextureBounds() const -> glm::vec4;
+        auto buildLods(const LodOptions& options) -> void;
         std::vector<data::Vertex> vertices;
         std::vector<uint32_t> indices;
+        std::vector<Lod> lods;
+    private:
+        auto parse(const char* file, const LodOptions& lodOptions) -> void;
+        auto readCache(const std::string& path, const CacheKey& key, const LodOptions& lodOptions) -> bool;
+        auto writeCache(const std::string& path, const CacheKey& key, const LodOptions& lodOptions) const -> void;
     };
-}
 
-namespace std {
-    template<> struct hash<vkr::data::Vertex> {
-        size_t operator()(vkr::data::Vertex const& vertex) const {
-            return ((hash<glm::vec3>()(vertex.position) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.textureCoordinates) << 1);
-        }
+    // The CPU side of every model the renderer holds: the source vertices and indices, one mesh per LOD level and the
+    // meshlets of each, in the order they are uploaded.
+    struct ModelStore {
+        Model model;
+        std::vector<Mesh> meshes;
+        std::vector<Meshlet> meshlets;
+        vk::IndexType indexType = vk::IndexType::eUint16;
     };
+
+    auto appendModel(ModelStore& store, const Model& data) -> uint32_t;
+    auto packVertices(const ModelStore& store, size_t begin, size_t end, PackedVertex* destination) -> void;
+    auto packIndices(const ModelStore& store, size_t begin, size_t end, void* destination) -> void;
 }
@@ -0,0 +1,163 @@
+#pragma once
+
+namespace vkr::hash {
+    namespace detail {
+        constexpr uint64_t prime1 = 0x9e3779b185ebca87ull;
+        constexpr uint64_t prime2 = 0xc2b2ae3d27d4eb4full;
+        constexpr uint64_t prime3 = 0x165667b19e3779f9ull;
+        constexpr uint64_t prime4 = 0x85ebca77c2b2ae63ull;
+        constexpr uint64_t prime5 = 0x27d4eb2f165667c5ull;
+
+        constexpr auto rotate(uint64_t value, int bits) -> uint64_t {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        constexpr auto avalanche(uint64_t value) -> uint64_t {
+            value ^= value >> 33;
+            value *= prime2;
+            value ^= value >> 29;
+            value *= prime3;
+            value ^= value >> 32;
+            return value;
+        }
+    }
+
+    // XXH64-style rounds over 8-byte words, strong enough that linear probing stays short for float keys.
+    inline auto hashBytes(const void* data, size_t size, uint64_t seed = 0) -> uint64_t {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        uint64_t result = seed + detail::prime5 + size;
+
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, bytes + i, sizeof(word));
+            result ^= detail::rotate(word * detail::prime2, 31) * detail::prime1;
+            result = detail::rotate(result, 27) * detail::prime1 + detail::prime4;
+        }
+
+        for (; i < size; ++i) {
+            result ^= bytes[i] * detail::prime5;
+            result = detail::rotate(result, 11) * detail::prime1;
+        }
+
+        return detail::avalanche(result);
+    }
+
+    // Robin Hood open addressing keyed on the raw bytes of K, so K must not contain padding.
+    template <class K, class V>
+    class Table {
+        static_assert(std::is_trivially_copyable_v<K>, "Table keys are compared and hashed as bytes");
+    public:
+        Table(size_t expected = 0) {
+            reserve(expected);
+        }
+
+        auto reserve(size_t expected) -> void {
+            size_t capacity = minCapacity;
+            while (capacity * maxLoadNumerator / maxLoadDenominator < expected) {
+                capacity *= 2;
+            }
+            if (capacity > entries.size()) {
+                rehash(capacity);
+            }
+        }
+
+        auto tryEmplace(const K& key, V value) -> std::pair<V&, bool> {
+            if ((count + 1) * maxLoadDenominator > entries.size() * maxLoadNumerator) {
+                rehash(entries.size() * 2);
+            }
+
+            uint64_t hash = hashBytes(&key, sizeof(K));
+            size_t mask = entries.size() - 1;
+            size_t position = static_cast<size_t>(hash) & mask;
+            uint8_t distance = 1;
+
+            while (distances[position] >= distance) {
+                if (distances[position] == distance && memcmp(&entries[position].key, &key, sizeof(K)) == 0) {
+                    return { entries[position].value, false };
+                }
+                position = (position + 1) & mask;
+                distance++;
+
+                if (distance == std::numeric_limits<uint8_t>::max()) {
+                    rehash(entries.size() * 2);
+                    return tryEmplace(key, std::move(value));
+                }
+            }
+
+            size_t inserted = position;
+            Entry entry { key, std::move(value) };
+            count++;
+
+            while (distances[position] != 0) {
+                if (distances[position] < distance) {
+                    std::swap(entries[position], entry);
+                    std::swap(distances[position], distance);
+                }
+                position = (position + 1) & mask;
+                distance++;
+
+                if (distance == std::numeric_limits<uint8_t>::max()) {
+                    count--;
+                    K displaced = entry.key;
+                    V displacedValue = std::move(entry.value);
+                    rehash(entries.size() * 2);
+                    tryEmplace(displaced, std::move(displacedValue));
+                    return { *find(key), true };
+                }
+            }
+
+            entries[position] = std::move(entry);
+            distances[position] = distance;
+
+            return { entries[inserted].value, true };
+        }
+
+        auto find(const K& key) -> V* {
+            uint64_t hash = hashBytes(&key, sizeof(K));
+            size_t mask = entries.size() - 1;
+            size_t position = static_cast<size_t>(hash) & mask;
+
+            for (uint8_t distance = 1; distances[position] >= distance; ++distance) {
+                if (distances[position] == distance && memcmp(&entries[position].key, &key, sizeof(K)) == 0) {
+                    return &entries[position].value;
+                }
+                position = (position + 1) & mask;
+            }
+            return nullptr;
+        }
+
+        auto getSize() const -> size_t {
+            return count;
+        }
+
+        auto getCapacity() const -> size_t {
+            return entries.size();
+        }
+    private:
+        struct Entry {
+            K key;
+            V value;
+        };
+
+        static constexpr size_t minCapacity = 16;
+        static constexpr size_t maxLoadNumerator = 7;
+        static constexpr size_t maxLoadDenominator = 8;
+
+        auto rehash(size_t capacity) -> void {
+            std::vector<Entry> oldEntries = std::exchange(entries, std::vector<Entry>(capacity));
+            std::vector<uint8_t> oldDistances = std::exchange(distances, std::vector<uint8_t>(capacity, 0));
+            count = 0;
+
+            for (size_t i = 0; i < oldEntries.size(); ++i) {
+                if (oldDistances[i] != 0) {
+                    tryEmplace(oldEntries[i].key, std::move(oldEntries[i].value));
+                }
+            }
+        }
+
+        std::vector<Entry> entries;
+        std::vector<uint8_t> distances;
+        size_t count = 0;
+    };
+}
@@ -13,7 +13,7 @@ namespace vkr::io::file {
     auto read<uint8_t>(const char* file) -> std::vector<uint8_t> {
         std::ifstream stream(file, std::ios::ate | std::ios::binary);
 
-        if (!file) {
+        if (!stream) {
             throw std::runtime_error(fmt::format("Failed to open {}", file));
         }
 
@@ -36,8 +36,94 @@ namespace vkr::io::file {
         memcpy(aligned.data(), data.data(), data.size());
         return aligned;
     }
+
+#ifdef _WIN32
+    Mapping::Mapping(const char* file) {
+        using namespace windows;
+
+        this->file = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (this->file == INVALID_HANDLE_VALUE) {
+            this->file = nullptr;
+            throw std::runtime_error(fmt::format("Failed to open {}", file));
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(this->file, &fileSize)) {
+            CloseHandle(this->file);
+            throw std::runtime_error(fmt::format("Failed to get the size of {}", file));
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+
+        if (size == 0) {
+            return;
+        }
+
+        mapping = CreateFileMappingA(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (!data) {
+            if (mapping) {
+                CloseHandle(mapping);
+            }
+            CloseHandle(this->file);
+            throw std::runtime_error(fmt::format("Failed to map {}", file));
+        }
+    }
+
+    Mapping::~Mapping() {
+        using namespace windows;
+
+        if (data) {
+            UnmapViewOfFile(data);
+        }
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        if (file) {
+            CloseHandle(file);
+        }
+    }
+#else
+    Mapping::Mapping(const char* file) {
+        int descriptor = open(file, O_RDONLY);
+        if (descriptor < 0) {
+            throw std::runtime_error(fmt::format("Failed to open {}", file));
+        }
+
+        struct stat status;
+        if (fstat(descriptor, &status) != 0) {
+            close(descriptor);
+            throw std::runtime_error(fmt::format("Failed to get the size of {}", file));
+        }
+        size = static_cast<size_t>(status.st_size);
+
+        if (size != 0) {
+            void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapped == MAP_FAILED) {
+                close(descriptor);
+                throw std::runtime_error(fmt::format("Failed to map {}", file));
+            }
+            madvise(mapped, size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapped);
+        }
+
+        close(descriptor);
+    }
+
+    Mapping::~Mapping() {
+        if (data) {
+            munmap(const_cast<char*>(data), size);
+        }
+    }
+#endif
+
+    auto Mapping::getData() const -> std::string_view {
+        return std::string_view(data, size);
+    }
 }
 
+#ifndef VKR_NO_WINDOW
 namespace vkr::io {
     auto Keyboard::getKeyPressed(Key key) -> bool {
         return glfw::glfwGetKey(windowGLFW, static_cast<int>(key)) == GLFW_PRESS;
@@ -238,4 +324,5 @@ namespace vkr::io {
         window.eventArena.clear();
         glfw::glfwPollEvents();
     }
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
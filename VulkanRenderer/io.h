@@ -1,5 +1,6 @@
 #pragma once
 
+#ifndef VKR_NO_WINDOW
 namespace vkr::io {
     enum class Key {
         eUnknown = GLFW_KEY_UNKNOWN,
@@ -162,6 +163,7 @@ namespace vkr::io::event {
         glm::ivec2 size;
     };
 }
+#endif
 
 namespace vkr::io::console {
     auto read() -> std::string;
@@ -170,8 +172,24 @@ namespace vkr::io::console {
 namespace vkr::io::file {
     template <class T>
     auto read(const char* file) -> std::vector<T>;
+
+    class Mapping {
+    public:
+        Mapping(const char* file);
+        Mapping(const Mapping&) = delete;
+        ~Mapping();
+        auto getData() const -> std::string_view;
+    private:
+        const char* data = nullptr;
+        size_t size = 0;
+#ifdef _WIN32
+        windows::HANDLE file = nullptr;
+        windows::HANDLE mapping = nullptr;
+#endif
+    };
 }
 
+#ifndef VKR_NO_WINDOW
 namespace vkr::io {
     struct WindowCreateInfo {
         glm::ivec2 size = glm::ivec2(640, 480);
@@ -255,4 +273,5 @@ namespace vkr::io {
     private:
         Window window;
     };
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include "ktx.h"
+#include "bc.h"
+#include "io.h"
+
+namespace vkr::ktx {
+    namespace {
+        constexpr std::array<uint8_t, 12> identifier = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+        constexpr uint64_t levelAlignment = 16;
+
+        struct Header {
+            std::array<uint8_t, 12> identifier = ktx::identifier;
+            uint32_t format = 0;
+            uint32_t typeSize = 1;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t depth = 0;
+            uint32_t layerCount = 0;
+            uint32_t faceCount = 1;
+            uint32_t levelCount = 0;
+            uint32_t supercompressionScheme = 0;
+            uint32_t dfdOffset = 0;
+            uint32_t dfdLength = 0;
+            uint32_t kvdOffset = 0;
+            uint32_t kvdLength = 0;
+            uint64_t sgdOffset = 0;
+            uint64_t sgdLength = 0;
+        };
+        static_assert(sizeof(Header) == 80, "KTX2 header layout");
+
+        struct LevelIndex {
+            uint64_t offset = 0;
+            uint64_t length = 0;
+            uint64_t uncompressedLength = 0;
+        };
+
+        struct Sample {
+            uint32_t channel = 0;
+            uint32_t bitOffset = 0;
+            uint32_t bitLength = 0;
+            uint32_t upper = 0;
+        };
+
+        constexpr uint32_t modelRgbsda = 1;
+        constexpr uint32_t modelBc1 = 128;
+        constexpr uint32_t modelBc3 = 130;
+        constexpr uint32_t modelBc4 = 131;
+        constexpr uint32_t modelBc5 = 132;
+        constexpr uint32_t modelBc7 = 134;
+        constexpr uint32_t channelAlpha = 15;
+        constexpr uint32_t qualifierLinear = 0x80;
+
+        auto alignOffset(uint64_t offset) -> uint64_t {
+            return (offset + levelAlignment - 1) / levelAlignment * levelAlignment;
+        }
+
+        auto isSrgb(vk::Format format) -> bool {
+            return format == vk::Format::eR8G8B8A8Srgb || (bc::getBlockSize(format) != 0 && bc::getDecompressedFormat(format) == vk::Format::eR8G8B8A8Srgb);
+        }
+
+        // A basic data format descriptor, which KTX2 requires even though the vkFormat field already says everything
+        // this loader needs.
+        auto getDataFormatDescriptor(vk::Format format) -> std::vector<uint32_t> {
+            uint32_t model = 0;
+            std::vector<Sample> samples;
+
+            switch (format) {
+            case vk::Format::eR8G8B8A8Unorm:
+            case vk::Format::eR8G8B8A8Srgb:
+                model = modelRgbsda;
+                samples = { { 0, 0, 8, 255 }, { 1, 8, 8, 255 }, { 2, 16, 8, 255 }, { channelAlpha, 24, 8, 255 } };
+                break;
+            case vk::Format::eBc1RgbUnormBlock:
+            case vk::Format::eBc1RgbSrgbBlock:
+                model = modelBc1;
+                samples = { { 0, 0, 64, UINT32_MAX } };
+                break;
+            case vk::Format::eBc1RgbaUnormBlock:
+            case vk::Format::eBc1RgbaSrgbBlock:
+                model = modelBc1;
+                samples = { { 1, 0, 64, UINT32_MAX } };
+                break;
+            case vk::Format::eBc3UnormBlock:
+            case vk::Format::eBc3SrgbBlock:
+                model = modelBc3;
+                samples = { { channelAlpha, 0, 64, UINT32_MAX }, { 0, 64, 64, UINT32_MAX } };
+                break;
+            case vk::Format::eBc4UnormBlock:
+                model = modelBc4;
+                samples = { { 0, 0, 64, UINT32_MAX } };
+                break;
+            case vk::Format::eBc5UnormBlock:
+                model = modelBc5;
+                samples = { { 0, 0, 64, UINT32_MAX }, { 1, 64, 64, UINT32_MAX } };
+                break;
+            case vk::Format::eBc7UnormBlock:
+            case vk::Format::eBc7SrgbBlock:
+                model = modelBc7;
+                samples = { { 0, 0, 128, UINT32_MAX } };
+                break;
+            default:
+                throw std::runtime_error(fmt::format("Can't write {} textures to KTX2", vk::to_string(format)));
+            }
+
+            bool srgb = isSrgb(format);
+            uint32_t blockDimension = model == modelRgbsda ? 0 : 3;
+            uint32_t blockBytes = model == modelRgbsda ? 4 : static_cast<uint32_t>(bc::getBlockSize(format));
+            auto blockSize = static_cast<uint32_t>(24 + samples.size() * 16);
+
+            std::vector<uint32_t> words = {
+                blockSize + 4,
+                0,
+                2 | blockSize << 16,
+                model | 1 << 8 | (srgb ? 2 : 1) << 16,
+                blockDimension | blockDimension << 8,
+                blockBytes,
+                0
+            };
+            for (const Sample& sample : samples) {
+                uint32_t qualifiers = sample.channel == channelAlpha && srgb ? qualifierLinear : 0;
+                words.push_back(sample.bitOffset | (sample.bitLength - 1) << 16 | (sample.channel | qualifiers) << 24);
+                words.push_back(0);
+                words.push_back(0);
+                words.push_back(sample.upper);
+            }
+            return words;
+        }
+
+        // Entries are sorted by key as the format requires, and every one is padded to four bytes.
+        auto getKeyValueData(std::span<const KeyValue> keyValues) -> std::vector<uint8_t> {
+            std::vector<KeyValue> entries(keyValues.begin(), keyValues.end());
+            entries.push_back({ "KTXwriter", "VulkanRenderer" });
+            std::sort(entries.begin(), entries.end(), [](const KeyValue& a, const KeyValue& b) {
+                return a.key < b.key;
+            });
+
+            std::vector<uint8_t> data;
+            for (const KeyValue& entry : entries) {
+                auto length = static_cast<uint32_t>(entry.key.size() + entry.value.size() + 2);
+                size_t offset = data.size();
+                data.resize(offset + sizeof(length) + length);
+                memcpy(data.data() + offset, &length, sizeof(length));
+                memcpy(data.data() + offset + sizeof(length), entry.key.c_str(), entry.key.size() + 1);
+                memcpy(data.data() + offset + sizeof(length) + entry.key.size() + 1, entry.value.c_str(), entry.value.size() + 1);
+                data.resize((data.size() + 3) / 4 * 4);
+            }
+            return data;
+        }
+
+        auto readHeader(const char* file, std::string_view data) -> Header {
+            Header header;
+            if (data.size() < sizeof(header)) {
+                throw std::runtime_error(fmt::format("{} is not a KTX2 file", file));
+            }
+            memcpy(&header, data.data(), sizeof(header));
+
+            if (header.identifier != identifier) {
+                throw std::runtime_error(fmt::format("{} is not a KTX2 file", file));
+            }
+            return header;
+        }
+    }
+
+    // Only single face, single layer 2D textures without supercompression are read, which is what the transcoder writes.
+    auto read(const char* file) -> data::Texture {
+        io::file::Mapping mapping(file);
+        std::string_view data = mapping.getData();
+
+        Header header = readHeader(file, data);
+        if (header.depth != 0 || header.layerCount != 0 || header.faceCount != 1 || header.supercompressionScheme != 0 || header.width == 0) {
+            throw std::runtime_error(fmt::format("{} is not a plain 2D KTX2 texture", file));
+        }
+
+        uint32_t levelCount = std::max(header.levelCount, 1u);
+        if (sizeof(header) + levelCount * sizeof(LevelIndex) > data.size()) {
+            throw std::runtime_error(fmt::format("{} is truncated", file));
+        }
+
+        std::vector<LevelIndex> index(levelCount);
+        memcpy(index.data(), data.data() + sizeof(header), levelCount * sizeof(LevelIndex));
+
+        uint64_t total = 0;
+        for (const LevelIndex& level : index) {
+            if (level.offset + level.length > data.size()) {
+                throw std::runtime_error(fmt::format("{} is truncated", file));
+            }
+            total = alignOffset(total) + level.length;
+        }
+
+        std::vector<uint8_t> pixels(static_cast<size_t>(total));
+        std::vector<data::TextureLevel> levels;
+        uint64_t offset = 0;
+        for (const LevelIndex& level : index) {
+            offset = alignOffset(offset);
+            memcpy(pixels.data() + offset, data.data() + level.offset, static_cast<size_t>(level.length));
+            levels.push_back({ static_cast<size_t>(offset), static_cast<size_t>(level.length) });
+            offset += level.length;
+        }
+
+        glm::ivec2 size(static_cast<int32_t>(header.width), static_cast<int32_t>(std::max(header.height, 1u)));
+        return data::Texture(static_cast<vk::Format>(header.format), size, std::move(pixels), std::move(levels));
+    }
+
+    auto readKeyValues(const char* file) -> std::vector<KeyValue> {
+        io::file::Mapping mapping(file);
+        std::string_view data = mapping.getData();
+
+        Header header = readHeader(file, data);
+        if (static_cast<uint64_t>(header.kvdOffset) + header.kvdLength > data.size()) {
+            throw std::runtime_error(fmt::format("{} is truncated", file));
+        }
+
+        std::vector<KeyValue> keyValues;
+        std::string_view entries = data.substr(header.kvdOffset, header.kvdLength);
+        while (entries.size() >= sizeof(uint32_t)) {
+            uint32_t length;
+            memcpy(&length, entries.data(), sizeof(length));
+            if (length > entries.size() - sizeof(length)) {
+                break;
+            }
+
+            std::string_view entry = entries.substr(sizeof(length), length);
+            size_t separator = entry.find('\0');
+            if (separator != std::string_view::npos) {
+                std::string_view value = entry.substr(separator + 1);
+                if (!value.empty() && value.back() == '\0') {
+                    value.remove_suffix(1);
+                }
+                keyValues.push_back({ std::string(entry.substr(0, separator)), std::string(value) });
+            }
+
+            entries.remove_prefix(std::min<size_t>(entries.size(), (sizeof(length) + length + 3) / 4 * 4));
+        }
+        return keyValues;
+    }
+
+    // Levels are stored smallest first, as the format asks, so a streaming reader can show something early.
+    auto write(const char* file, const data::Texture& texture, std::span<const KeyValue> keyValues) -> void {
+        std::vector<uint32_t> descriptor = getDataFormatDescriptor(texture.getFormat());
+        std::vector<uint8_t> keyValueData = getKeyValueData(keyValues);
+        std::span<const data::TextureLevel> levels = texture.getLevels();
+
+        Header header;
+        header.format = static_cast<uint32_t>(texture.getFormat());
+        header.width = static_cast<uint32_t>(texture.getDimentions().x);
+        header.height = static_cast<uint32_t>(texture.getDimentions().y);
+        header.levelCount = static_cast<uint32_t>(levels.size());
+        header.dfdOffset = static_cast<uint32_t>(sizeof(header) + levels.size() * sizeof(LevelIndex));
+        header.dfdLength = static_cast<uint32_t>(descriptor.size() * sizeof(uint32_t));
+        header.kvdOffset = header.dfdOffset + header.dfdLength;
+        header.kvdLength = static_cast<uint32_t>(keyValueData.size());
+
+        std::vector<LevelIndex> index(levels.size());
+        uint64_t offset = header.kvdOffset + header.kvdLength;
+        for (size_t i = levels.size(); i-- > 0;) {
+            offset = alignOffset(offset);
+            index[i].offset = offset;
+            index[i].length = levels[i].size;
+            index[i].uncompressedLength = levels[i].size;
+            offset += levels[i].size;
+        }
+
+        std::string temporary = std::string(file) + ".tmp";
+        {
+            std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+            if (!stream) {
+                throw std::runtime_error(fmt::format("Couldn't write {}", file));
+            }
+
+            auto pad = [&](uint64_t offset) {
+                static constexpr std::array<char, levelAlignment> zeros = {};
+                stream.write(zeros.data(), static_cast<std::streamsize>(offset - static_cast<uint64_t>(stream.tellp())));
+            };
+
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(LevelIndex)));
+            stream.write(reinterpret_cast<const char*>(descriptor.data()), static_cast<std::streamsize>(descriptor.size() * sizeof(uint32_t)));
+            stream.write(reinterpret_cast<const char*>(keyValueData.data()), static_cast<std::streamsize>(keyValueData.size()));
+            for (size_t i = levels.size(); i-- > 0;) {
+                pad(index[i].offset);
+                stream.write(reinterpret_cast<const char*>(texture.getPixels() + levels[i].offset), static_cast<std::streamsize>(levels[i].size));
+            }
+
+            if (!stream) {
+                throw std::runtime_error(fmt::format("Couldn't write {}", file));
+            }
+        }
+
+        std::filesystem::rename(temporary, file);
+    }
+}
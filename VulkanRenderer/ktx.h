@@ -0,0 +1,13 @@
+#pragma once
+#include "data.h"
+
+namespace vkr::ktx {
+    struct KeyValue {
+        std::string key;
+        std::string value;
+    };
+
+    auto read(const char* file) -> data::Texture;
+    auto readKeyValues(const char* file) -> std::vector<KeyValue>;
+    auto write(const char* file, const data::Texture& texture, std::span<const KeyValue> keyValues = {}) -> void;
+}
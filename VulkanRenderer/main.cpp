@@ -1,16 +1,41 @@
 #include "main.h"
+#include "bench.h"
+#include "transcode.h"
 
 namespace vkr::api {
     Renderer::Renderer(api::RendererCreateInfo&& rendererCreateInfo) : part::LastPart(std::move(rendererCreateInfo)) {}
 
-    auto Renderer::pushModel(const data::Model& model) -> void {
-        getDevice().waitIdle();
-        LastPart::pushModel(model);
+    auto Renderer::pushModel(const data::Model& model) -> uint32_t {
+        return LastPart::pushModel(model);
     }
 
-    auto Renderer::getVertexSpan() -> std::span<data::Vertex> {
+    auto Renderer::addInstance(uint32_t mesh, const glm::mat4& transform, uint32_t texture) -> uint32_t {
+        return LastPart::addInstance(mesh, transform, texture);
+    }
+
+    auto Renderer::setInstanceTransform(uint32_t instance, const glm::mat4& transform) -> void {
+        LastPart::setInstanceTransform(instance, transform);
+    }
+
+    auto Renderer::setInstanceTexture(uint32_t instance, uint32_t texture) -> void {
+        LastPart::setInstanceTexture(instance, texture);
+    }
+
+    auto Renderer::removeInstance(uint32_t instance) -> void {
+        LastPart::removeInstance(instance);
+    }
+
+    auto Renderer::getVertexSpan() -> std::span<const data::Vertex> {
         return LastPart::getVertexSpan();
     }
+
+    auto Renderer::getVertexSpan(size_t offset, size_t count) -> std::span<data::Vertex> {
+        return LastPart::getVertexSpan(offset, count);
+    }
+
+    auto Renderer::markDirty(size_t offset, size_t count) -> void {
+        LastPart::markDirty(offset, count);
+    }
     
     auto Renderer::getCamera() -> data::Camera& {
         return LastPart::getCamera();
@@ -20,19 +45,55 @@ namespace vkr::api {
         return getWindowHandle().getWindow();
     }
 
-    auto Renderer::setTexture(const data::Texture& texture) -> void {
-        getDevice().waitIdle();
-        LastPart::setTexture(texture);
-        rebuildDescriptorSets();
+    auto Renderer::pushTexture(const data::Texture& texture, bool dynamic) -> uint32_t {
+        return LastPart::pushTexture(texture, dynamic);
+    }
+
+    auto Renderer::setTexture(uint32_t texture, const data::Texture& data, bool dynamic) -> void {
+        LastPart::setTexture(texture, data, dynamic);
+    }
+
+    auto Renderer::markTextureDirty(uint32_t texture) -> void {
+        LastPart::markTextureDirty(texture);
+    }
+
+    auto Renderer::getMemoryStatistics() -> std::vector<memory::HeapStatistics> {
+        return getAllocator().getStatistics();
+    }
+
+    auto Renderer::getTriangleCount() -> size_t {
+        return LastPart::getTriangleCount();
+    }
+
+    auto Renderer::getDrawCount() -> size_t {
+        return getDraws().size();
     }
     
     auto Renderer::runLoop() -> void {
         LastPart::runLoop();
     }
+
+    auto Renderer::renderFrame() -> void {
+        LastPart::renderFrame();
+    }
+
+    auto Renderer::runFrames(size_t count) -> void {
+        LastPart::runFrames(count);
+    }
+
+    auto Renderer::finishFrames() -> void {
+        LastPart::finishFrames();
+    }
 }
 
 namespace vkr::test {
-    Application::Application() : api::Renderer(std::move(rendererCreateInfo())) {}
+    Application::Application() : api::Renderer(std::move(rendererCreateInfo())) {
+        for (const data::Vertex& vertex : room.vertices) {
+            roomCenter += vertex.position;
+        }
+        roomCenter /= static_cast<float>(std::max<size_t>(room.vertices.size(), 1));
+        roomMesh = pushModel(room);
+    }
 
     auto Application::rendererCreateInfo() -> api::RendererCreateInfo {
         api::RendererCreateInfo info;
@@ -82,23 +143,19 @@ namespace vkr::test {
             }
             else {
                 if (e.button == io::Button::eLeft) {
-                    data::Model roomRelative = room;
-                    for (auto& vertex : roomRelative.vertices) {
-                        vertex.position += (getCamera().position + getCamera().getDirection() * 2.0f) * glm::vec3(-1.0f, 1.0f, -1.0f);
-                    }
-                    pushModel(roomRelative);
-                    View view;
-                    view.start = getVertexSpan().size() - roomRelative.vertices.size();
-                    view.count = roomRelative.vertices.size();
-                    models.push_back(view);
+                    Object object;
+                    object.position = (getCamera().position + getCamera().getDirection() * 2.0f) * glm::vec3(-1.0f, 1.0f, -1.0f);
+                    object.angle = 0.0f;
+                    object.instance = addInstance(roomMesh, glm::translate(glm::mat4(1.0f), object.position));
+                    objects.push_back(object);
                 }
                 else if (e.button == io::Button::eRight) {
                     static bool flag;
                     if (flag) {
-                        setTexture(roomTexture);
+                        setTexture(0, roomTexture);
                     }
                     else {
-                        setTexture(orangeTexture);
+                        setTexture(0, orangeTexture);
                     }
                     flag = !flag;
                 }
@@ -134,29 +191,24 @@ namespace vkr::test {
         getCamera().position += getCamera().getLeft() * getWindow().getKeyboard().getKeyScalar(io::Key::eA, io::Key::eD) * delta * 2.0f;
         getCamera().position.z += getWindow().getKeyboard().getKeyScalar(io::Key::eLeftShift, io::Key::eSpace) * delta * 2.0f;
 
-        try {
-            size_t index = 0;
-            for (View model : models) {
-                glm::vec3 center(0.0f);
-                for (data::Vertex& vertex : getVertexSpan().subspan(model.start, model.count)) {
-                    center += vertex.position;
-                }
-                center /= static_cast<float>(model.count);
-                
-                for (data::Vertex& vertex : getVertexSpan().subspan(model.start, model.count)) {
-                    vertex.position -= center;
-                    vertex.position = glm::rotateZ(vertex.position, delta);
-                    vertex.position += center;
-                }
-            }
-            index++;
+        for (Object& object : objects) {
+            object.angle += delta;
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), object.position + roomCenter);
+            transform = glm::rotate(transform, object.angle, glm::vec3(0.0f, 0.0f, 1.0f));
+            transform = glm::translate(transform, -roomCenter);
+            setInstanceTransform(object.instance, transform);
         }
-        catch (...) {}
     }
 }
 
-int main() {
+int main(int argc, char** argv) {
     try {
+        if (argc > 1 && std::string_view(argv[1]) == "bench") {
+            return vkr::bench::run(std::span<char*>(argv + 2, static_cast<size_t>(argc - 2)));
+        }
+        if (argc > 1 && std::string_view(argv[1]) == "transcode") {
+            return vkr::transcode::run(std::span<char*>(argv + 2, static_cast<size_t>(argc - 2)));
+        }
         vkr::test::Application().runLoop();
     }
     catch (const std::exception& e) {
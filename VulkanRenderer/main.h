@@ -5,19 +5,34 @@ namespace vkr::api {
     class Renderer : private part::LastPart {
     public:
         Renderer(api::RendererCreateInfo&& rendererCreateInfo);
-        auto pushModel(const data::Model& model) -> void;
-        auto getVertexSpan() -> std::span<data::Vertex>;
+        auto pushModel(const data::Model& model) -> uint32_t;
+        auto addInstance(uint32_t mesh, const glm::mat4& transform, uint32_t texture = 0) -> uint32_t;
+        auto setInstanceTransform(uint32_t instance, const glm::mat4& transform) -> void;
+        auto setInstanceTexture(uint32_t instance, uint32_t texture) -> void;
+        auto removeInstance(uint32_t instance) -> void;
+        auto getVertexSpan() -> std::span<const data::Vertex>;
+        auto getVertexSpan(size_t offset, size_t count) -> std::span<data::Vertex>;
+        auto markDirty(size_t offset, size_t count) -> void;
         auto getCamera() -> data::Camera&;
         auto getWindow() -> io::Window&;
-        auto setTexture(const data::Texture& texture) -> void;
+        auto pushTexture(const data::Texture& texture, bool dynamic = false) -> uint32_t;
+        auto setTexture(uint32_t texture, const data::Texture& data, bool dynamic = false) -> void;
+        auto markTextureDirty(uint32_t texture) -> void;
+        auto getMemoryStatistics() -> std::vector<memory::HeapStatistics>;
+        auto getTriangleCount() -> size_t;
+        auto getDrawCount() -> size_t;
         auto runLoop() -> void;
+        auto renderFrame() -> void;
+        auto runFrames(size_t count) -> void;
+        auto finishFrames() -> void;
     };
 }
 
 namespace vkr::test {
-    struct View {
-        size_t start;
-        size_t count;
+    struct Object {
+        uint32_t instance;
+        glm::vec3 position;
+        float angle;
     };
 
     class Application : public api::Renderer {
@@ -28,7 +43,9 @@ namespace vkr::test {
     private:
         data::Model room { "models/room.obj" };
         data::Model orange { "models/orange.obj" };
-        std::vector<View> models;
+        uint32_t roomMesh = 0;
+        glm::vec3 roomCenter = glm::vec3(0.0f);
+        std::vector<Object> objects;
         data::Texture orangeTexture { "textures/orange.jpg" };
         data::Texture roomTexture { "textures/room.png" };
     private:
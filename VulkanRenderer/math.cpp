@@ -16,4 +16,23 @@ namespace vkr::math {
     constexpr auto squareSigned(float number) -> float {
         return number * number * sign(number);
     }
+
+    auto getFrustumPlanes(const glm::mat4& viewProjection) -> std::array<glm::vec4, 6> {
+        glm::mat4 rows = glm::transpose(viewProjection);
+
+        std::array<glm::vec4, 6> planes = {
+            rows[3] + rows[0],
+            rows[3] - rows[0],
+            rows[3] + rows[1],
+            rows[3] - rows[1],
+            rows[2],
+            rows[3] - rows[2]
+        };
+
+        for (glm::vec4& plane : planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+
+        return planes;
+    }
 }
\ No newline at end of file
@@ -4,4 +4,6 @@ namespace vkr::math {
     constexpr auto sign(float number) -> float;
 
     constexpr auto squareSigned(float number) -> float;
+
+    auto getFrustumPlanes(const glm::mat4& viewProjection) -> std::array<glm::vec4, 6>;
 }
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include "memory.h"
+
+namespace vkr::memory {
+    Allocation::Allocation(Allocation&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    auto Allocation::operator=(Allocation&& other) noexcept -> Allocation& {
+        if (this != &other) {
+            reset();
+            allocator = std::exchange(other.allocator, nullptr);
+            memory = std::exchange(other.memory, vk::DeviceMemory());
+            offset = std::exchange(other.offset, 0);
+            size = std::exchange(other.size, 0);
+            mapped = std::exchange(other.mapped, nullptr);
+            pool = std::exchange(other.pool, 0);
+            order = std::exchange(other.order, 0);
+            dedicated = std::exchange(other.dedicated, false);
+        }
+        return *this;
+    }
+
+    Allocation::~Allocation() {
+        reset();
+    }
+
+    auto Allocation::getMemory() const -> vk::DeviceMemory {
+        return memory;
+    }
+
+    auto Allocation::getOffset() const -> vk::DeviceSize {
+        return offset;
+    }
+
+    auto Allocation::getSize() const -> vk::DeviceSize {
+        return size;
+    }
+
+    auto Allocation::getMapped() const -> void* {
+        return mapped;
+    }
+
+    auto Allocation::reset() -> void {
+        if (allocator) {
+            allocator->free(*this);
+            allocator = nullptr;
+            memory = vk::DeviceMemory();
+            mapped = nullptr;
+        }
+    }
+
+    Allocation::operator bool() const {
+        return allocator != nullptr;
+    }
+
+    Allocator::Allocator(vk::PhysicalDevice physicalDevice, vk::Device device) : device(device) {
+        memoryProperties = physicalDevice.getMemoryProperties();
+        bufferImageGranularity = physicalDevice.getProperties().limits.bufferImageGranularity;
+        dedicatedStatistics.resize(memoryProperties.memoryHeapCount);
+
+        for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i) {
+            dedicatedStatistics[i].heapSize = memoryProperties.memoryHeaps[i].size;
+        }
+
+        pools.resize(static_cast<size_t>(memoryProperties.memoryTypeCount) * 2);
+
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+            vk::DeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[i].heapIndex].size;
+            vk::DeviceSize blockSize = preferredBlockSize;
+            while (blockSize > minAllocationSize && blockSize * 8 > heapSize) {
+                blockSize /= 2;
+            }
+
+            uint32_t maxOrder = 0;
+            while ((minAllocationSize << maxOrder) < blockSize) {
+                maxOrder++;
+            }
+
+            for (size_t kind = 0; kind < 2; ++kind) {
+                Pool& pool = pools[static_cast<size_t>(i) * 2 + kind];
+                pool.memoryType = i;
+                pool.blockSize = blockSize;
+                pool.maxOrder = maxOrder;
+            }
+        }
+    }
+
+    auto Allocator::allocate(vk::Buffer buffer, uint32_t memoryType) -> Allocation {
+        vk::MemoryRequirements requirements = device.getBufferMemoryRequirements(buffer);
+        vk::MemoryDedicatedAllocateInfo dedicatedInfo;
+        dedicatedInfo.buffer = buffer;
+        return allocate(requirements, memoryType, ResourceKind::eLinear, false, dedicatedInfo);
+    }
+
+    auto Allocator::allocate(vk::Image image, vk::ImageTiling tiling, uint32_t memoryType) -> Allocation {
+        vk::ImageMemoryRequirementsInfo2 requirementsInfo;
+        requirementsInfo.image = image;
+
+        auto chain = device.getImageMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(requirementsInfo);
+        const vk::MemoryRequirements& requirements = chain.get<vk::MemoryRequirements2>().memoryRequirements;
+        const vk::MemoryDedicatedRequirements& dedicatedRequirements = chain.get<vk::MemoryDedicatedRequirements>();
+
+        vk::MemoryDedicatedAllocateInfo dedicatedInfo;
+        dedicatedInfo.image = image;
+
+        ResourceKind kind = tiling == vk::ImageTiling::eOptimal ? ResourceKind::eOptimal : ResourceKind::eLinear;
+        const Pool& pool = pools[getPoolIndex(memoryType, kind)];
+
+        if (dedicatedRequirements.requiresDedicatedAllocation) {
+            return allocateDedicated(requirements.size, memoryType, dedicatedInfo);
+        }
+
+        bool big = requirements.size >= pool.blockSize / 4;
+        return allocate(requirements, memoryType, kind, big && dedicatedRequirements.prefersDedicatedAllocation, dedicatedInfo);
+    }
+
+    auto Allocator::getStatistics() -> std::vector<HeapStatistics> {
+        std::lock_guard lock(mutex);
+
+        std::vector<HeapStatistics> result = dedicatedStatistics;
+
+        for (const Pool& pool : pools) {
+            HeapStatistics& statistics = result[memoryProperties.memoryTypes[pool.memoryType].heapIndex];
+            for (const auto& block : pool.blocks) {
+                statistics.blockCount++;
+                statistics.blockBytes += pool.blockSize;
+                statistics.allocationCount += block->allocationCount;
+                statistics.allocationBytes += block->usedBytes;
+            }
+        }
+
+        return result;
+    }
+
+    auto Allocator::allocate(const vk::MemoryRequirements& requirements, uint32_t memoryType, ResourceKind kind, bool preferDedicated, vk::MemoryDedicatedAllocateInfo dedicatedInfo) -> Allocation {
+        uint32_t poolIndex = getPoolIndex(memoryType, kind);
+        Pool& pool = pools[poolIndex];
+
+        vk::DeviceSize size = std::max(requirements.size, requirements.alignment);
+        if (preferDedicated || size > pool.blockSize / 2) {
+            return allocateDedicated(requirements.size, memoryType, dedicatedInfo);
+        }
+
+        uint32_t order = getOrder(pool, size);
+
+        std::lock_guard lock(mutex);
+
+        for (size_t i = 0; i < pool.blocks.size(); ++i) {
+            if (std::optional<Allocation> allocation = allocateFromBlock(pool, poolIndex, i, order)) {
+                allocation->size = requirements.size;
+                return std::move(*allocation);
+            }
+        }
+
+        vk::MemoryAllocateInfo memoryAllocateInfo;
+        memoryAllocateInfo.allocationSize = pool.blockSize;
+        memoryAllocateInfo.memoryTypeIndex = memoryType;
+
+        auto block = std::make_unique<Block>();
+        block->memory = device.allocateMemoryUnique(memoryAllocateInfo);
+        if (isHostVisible(memoryType)) {
+            block->mapped = static_cast<uint8_t*>(device.mapMemory(*block->memory, 0, VK_WHOLE_SIZE));
+        }
+        block->freeOffsets.resize(static_cast<size_t>(pool.maxOrder) + 1);
+        block->freeOffsets[pool.maxOrder].insert(0);
+        pool.blocks.push_back(std::move(block));
+
+        Allocation allocation = std::move(*allocateFromBlock(pool, poolIndex, pool.blocks.size() - 1, order));
+        allocation.size = requirements.size;
+        return allocation;
+    }
+
+    auto Allocator::allocateDedicated(vk::DeviceSize size, uint32_t memoryType, vk::MemoryDedicatedAllocateInfo dedicatedInfo) -> Allocation {
+        vk::MemoryAllocateInfo memoryAllocateInfo;
+        memoryAllocateInfo.allocationSize = size;
+        memoryAllocateInfo.memoryTypeIndex = memoryType;
+        memoryAllocateInfo.pNext = &dedicatedInfo;
+
+        Allocation allocation;
+        allocation.allocator = this;
+        allocation.memory = device.allocateMemory(memoryAllocateInfo);
+        allocation.size = size;
+        allocation.pool = memoryType;
+        allocation.dedicated = true;
+
+        if (isHostVisible(memoryType)) {
+            allocation.mapped = static_cast<uint8_t*>(device.mapMemory(allocation.memory, 0, VK_WHOLE_SIZE));
+        }
+
+        std::lock_guard lock(mutex);
+        HeapStatistics& statistics = dedicatedStatistics[memoryProperties.memoryTypes[memoryType].heapIndex];
+        statistics.dedicatedCount++;
+        statistics.allocationCount++;
+        statistics.blockBytes += size;
+        statistics.allocationBytes += size;
+
+        return allocation;
+    }
+
+    auto Allocator::allocateFromBlock(Pool& pool, uint32_t poolIndex, size_t blockIndex, uint32_t order) -> std::optional<Allocation> {
+        Block& block = *pool.blocks[blockIndex];
+
+        uint32_t available = order;
+        while (available <= pool.maxOrder && block.freeOffsets[available].empty()) {
+            available++;
+        }
+
+        if (available > pool.maxOrder) {
+            return std::nullopt;
+        }
+
+        vk::DeviceSize offset = *block.freeOffsets[available].begin();
+        block.freeOffsets[available].erase(block.freeOffsets[available].begin());
+
+        while (available > order) {
+            available--;
+            block.freeOffsets[available].insert(offset + (minAllocationSize << available));
+        }
+
+        block.usedBytes += minAllocationSize << order;
+        block.allocationCount++;
+
+        Allocation allocation;
+        allocation.allocator = this;
+        allocation.memory = *block.memory;
+        allocation.offset = offset;
+        allocation.mapped = block.mapped ? block.mapped + offset : nullptr;
+        allocation.pool = poolIndex;
+        allocation.order = order;
+        return allocation;
+    }
+
+    auto Allocator::free(Allocation& allocation) -> void {
+        if (allocation.dedicated) {
+            if (allocation.mapped) {
+                device.unmapMemory(allocation.memory);
+            }
+            device.freeMemory(allocation.memory);
+
+            std::lock_guard lock(mutex);
+            HeapStatistics& statistics = dedicatedStatistics[memoryProperties.memoryTypes[allocation.pool].heapIndex];
+            statistics.dedicatedCount--;
+            statistics.allocationCount--;
+            statistics.blockBytes -= allocation.size;
+            statistics.allocationBytes -= allocation.size;
+            return;
+        }
+
+        std::lock_guard lock(mutex);
+
+        Pool& pool = pools[allocation.pool];
+        auto it = std::find_if(pool.blocks.begin(), pool.blocks.end(), [&](const auto& block) { return *block->memory == allocation.memory; });
+        Block& block = **it;
+
+        block.usedBytes -= minAllocationSize << allocation.order;
+        block.allocationCount--;
+
+        vk::DeviceSize offset = allocation.offset;
+        uint32_t order = allocation.order;
+
+        while (order < pool.maxOrder) {
+            vk::DeviceSize buddy = offset ^ (minAllocationSize << order);
+            auto found = block.freeOffsets[order].find(buddy);
+            if (found == block.freeOffsets[order].end()) {
+                break;
+            }
+            block.freeOffsets[order].erase(found);
+            offset = std::min(offset, buddy);
+            order++;
+        }
+
+        block.freeOffsets[order].insert(offset);
+
+        if (block.allocationCount == 0 && pool.blocks.size() > 1) {
+            pool.blocks.erase(it);
+        }
+    }
+
+    auto Allocator::getPoolIndex(uint32_t memoryType, ResourceKind kind) -> uint32_t {
+        if (bufferImageGranularity <= minAllocationSize) {
+            kind = ResourceKind::eLinear;
+        }
+        return memoryType * 2 + static_cast<uint32_t>(kind);
+    }
+
+    auto Allocator::getOrder(const Pool& pool, vk::DeviceSize size) -> uint32_t {
+        uint32_t order = 0;
+        while ((minAllocationSize << order) < size && order < pool.maxOrder) {
+            order++;
+        }
+        return order;
+    }
+
+    auto Allocator::isHostVisible(uint32_t memoryType) -> bool {
+        return static_cast<bool>(memoryProperties.memoryTypes[memoryType].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible);
+    }
+}
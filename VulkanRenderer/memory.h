@@ -0,0 +1,88 @@
+#pragma once
+
+namespace vkr::memory {
+    class Allocator;
+
+    enum class ResourceKind {
+        eLinear,
+        eOptimal
+    };
+
+    struct HeapStatistics {
+        vk::DeviceSize heapSize = 0;
+        vk::DeviceSize blockBytes = 0;
+        vk::DeviceSize allocationBytes = 0;
+        uint32_t blockCount = 0;
+        uint32_t dedicatedCount = 0;
+        uint32_t allocationCount = 0;
+    };
+
+    class Allocation {
+    public:
+        Allocation() = default;
+        Allocation(const Allocation&) = delete;
+        Allocation(Allocation&& other) noexcept;
+        auto operator=(Allocation&& other) noexcept -> Allocation&;
+        ~Allocation();
+        auto getMemory() const -> vk::DeviceMemory;
+        auto getOffset() const -> vk::DeviceSize;
+        auto getSize() const -> vk::DeviceSize;
+        auto getMapped() const -> void*;
+        auto reset() -> void;
+        explicit operator bool() const;
+    private:
+        friend class Allocator;
+        Allocator* allocator = nullptr;
+        vk::DeviceMemory memory;
+        vk::DeviceSize offset = 0;
+        vk::DeviceSize size = 0;
+        uint8_t* mapped = nullptr;
+        uint32_t pool = 0;
+        uint32_t order = 0;
+        bool dedicated = false;
+    };
+
+    class Allocator {
+    public:
+        Allocator(vk::PhysicalDevice physicalDevice, vk::Device device);
+        Allocator(const Allocator&) = delete;
+        auto allocate(vk::Buffer buffer, uint32_t memoryType) -> Allocation;
+        auto allocate(vk::Image image, vk::ImageTiling tiling, uint32_t memoryType) -> Allocation;
+        auto getStatistics() -> std::vector<HeapStatistics>;
+    private:
+        friend class Allocation;
+
+        struct Block {
+            vk::UniqueDeviceMemory memory;
+            uint8_t* mapped = nullptr;
+            std::vector<std::set<vk::DeviceSize>> freeOffsets;
+            vk::DeviceSize usedBytes = 0;
+            uint32_t allocationCount = 0;
+        };
+
+        struct Pool {
+            uint32_t memoryType = 0;
+            vk::DeviceSize blockSize = 0;
+            uint32_t maxOrder = 0;
+            std::vector<std::unique_ptr<Block>> blocks;
+        };
+
+        static constexpr vk::DeviceSize minAllocationSize = 256;
+        static constexpr vk::DeviceSize preferredBlockSize = 64ull * 1024 * 1024;
+
+        auto allocate(const vk::MemoryRequirements& requirements, uint32_t memoryType, ResourceKind kind, bool preferDedicated, vk::MemoryDedicatedAllocateInfo dedicatedInfo) -> Allocation;
+        auto allocateDedicated(vk::DeviceSize size, uint32_t memoryType, vk::MemoryDedicatedAllocateInfo dedicatedInfo) -> Allocation;
+        auto allocateFromBlock(Pool& pool, uint32_t poolIndex, size_t blockIndex, uint32_t order) -> std::optional<Allocation>;
+        auto free(Allocation& allocation) -> void;
+        auto getPoolIndex(uint32_t memoryType, ResourceKind kind) -> uint32_t;
+        auto getOrder(const Pool& pool, vk::DeviceSize size) -> uint32_t;
+        auto isHostVisible(uint32_t memoryType) -> bool;
+
+        std::mutex mutex;
+        vk::Device device;
+        vk::PhysicalDeviceMemoryProperties memoryProperties;
+        vk::DeviceSize bufferImageGranularity = 1;
+        std::vector<Pool> pools;
+        std::vector<HeapStatistics> dedicatedStatistics;
+    };
+}
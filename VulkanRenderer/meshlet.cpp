@@ -0,0 +1,105 @@
+#include "meshlet.h"
+
+namespace vkr::meshlet {
+    // Cuts the index buffer into consecutive runs of triangles, so a meshlet is just an index range and the order produced
+    // by optimize::optimizeVertexCache already keeps each run's vertices together.
+    auto buildMeshlets(std::span<const uint32_t> indices, std::span<const data::Vertex> vertices) -> std::vector<data::Meshlet> {
+        std::vector<data::Meshlet> meshlets;
+
+        constexpr uint32_t unused = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> owners(vertices.size(), unused);
+
+        auto finish = [&](size_t begin, size_t end, uint32_t vertexCount) {
+            data::Meshlet meshlet;
+            meshlet.firstIndex = static_cast<uint32_t>(begin);
+            meshlet.indexCount = static_cast<uint32_t>(end - begin);
+            meshlet.vertexCount = vertexCount;
+            std::tie(meshlet.bounds, meshlet.cone) = getMeshletBounds(indices.subspan(begin, end - begin), vertices);
+            meshlets.push_back(meshlet);
+        };
+
+        size_t begin = 0;
+        uint32_t vertexCount = 0;
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            auto id = static_cast<uint32_t>(meshlets.size());
+
+            uint32_t added = 0;
+            for (size_t corner = 0; corner < 3; ++corner) {
+                added += owners[indices[i + corner]] != id ? 1 : 0;
+            }
+
+            if (vertexCount + added > maxVertices || (i - begin) / 3 + 1 > maxTriangles) {
+                finish(begin, i, vertexCount);
+                begin = i;
+                vertexCount = 0;
+                id++;
+            }
+
+            for (size_t corner = 0; corner < 3; ++corner) {
+                uint32_t& owner = owners[indices[i + corner]];
+                if (owner != id) {
+                    owner = id;
+                    vertexCount++;
+                }
+            }
+        }
+
+        if (begin < indices.size() / 3 * 3) {
+            finish(begin, indices.size() / 3 * 3, vertexCount);
+        }
+
+        return meshlets;
+    }
+
+    // The cone follows meshoptimizer's convention: the meshlet can be skipped when
+    // dot(center - camera, axis) >= cutoff * length(center - camera) + radius.
+    auto getMeshletBounds(std::span<const uint32_t> indices, std::span<const data::Vertex> vertices) -> std::tuple<glm::vec4, glm::vec4> {
+        if (indices.empty()) {
+            return { glm::vec4(0.0f), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f) };
+        }
+
+        glm::vec3 minimum = vertices[indices[0]].position;
+        glm::vec3 maximum = minimum;
+        for (uint32_t index : indices) {
+            minimum = glm::min(minimum, vertices[index].position);
+            maximum = glm::max(maximum, vertices[index].position);
+        }
+
+        glm::vec3 center = (minimum + maximum) * 0.5f;
+        float radius = 0.0f;
+        for (uint32_t index : indices) {
+            radius = std::max(radius, glm::distance(center, vertices[index].position));
+        }
+
+        std::vector<glm::vec3> normals;
+        normals.reserve(indices.size() / 3);
+        glm::vec3 axis(0.0f);
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const glm::vec3& a = vertices[indices[i + 0]].position;
+            const glm::vec3& b = vertices[indices[i + 1]].position;
+            const glm::vec3& c = vertices[indices[i + 2]].position;
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            float length = glm::length(normal);
+            if (length > 0.0f) {
+                normals.push_back(normal / length);
+                axis += normals.back();
+            }
+        }
+
+        float axisLength = glm::length(axis);
+        if (normals.empty() || axisLength == 0.0f) {
+            return { glm::vec4(center, radius), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f) };
+        }
+        axis /= axisLength;
+
+        float minimumDot = 1.0f;
+        for (const glm::vec3& normal : normals) {
+            minimumDot = std::min(minimumDot, glm::dot(axis, normal));
+        }
+
+        // Cones wider than about 84 degrees can't be culled from any useful viewpoint.
+        float cutoff = minimumDot > 0.1f ? std::sqrt(1.0f - minimumDot * minimumDot) : 1.0f;
+        return { glm::vec4(center, radius), glm::vec4(axis, cutoff) };
+    }
+}
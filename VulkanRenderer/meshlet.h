@@ -0,0 +1,10 @@
+#pragma once
+#include "data.h"
+
+namespace vkr::meshlet {
+    constexpr size_t maxVertices = 64;
+    constexpr size_t maxTriangles = 124;
+
+    auto buildMeshlets(std::span<const uint32_t> indices, std::span<const data::Vertex> vertices) -> std::vector<data::Meshlet>;
+    auto getMeshletBounds(std::span<const uint32_t> indices, std::span<const data::Vertex> vertices) -> std::tuple<glm::vec4, glm::vec4>;
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include "pack.h"
 
 namespace vkr::meta {
     namespace detail {
@@ -101,6 +102,12 @@ namespace vkr::meta {
             if (std::is_same_v<F, glm::u64vec4>) {
                 return vk::Format::eR64G64B64A64Uint;
             }
+            if (std::is_same_v<F, pack::Snorm16x4>) {
+                return vk::Format::eR16G16B16A16Snorm;
+            }
+            if (std::is_same_v<F, pack::Unorm16x2>) {
+                return vk::Format::eR16G16Unorm;
+            }
             assert(!"Format is not supported");
             return vk::Format::eUndefined;
         }
@@ -0,0 +1,310 @@
+#include "microbench.h"
+#include "bc.h"
+#include "hash.h"
+#include "ktx.h"
+#include "mip.h"
+#include "optimize.h"
+
+namespace {
+    std::atomic<uint64_t> allocationCount = 0;
+}
+
+auto operator new(size_t size) -> void* {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+auto operator delete(void* pointer) noexcept -> void {
+    std::free(pointer);
+}
+
+auto operator delete(void* pointer, size_t) noexcept -> void {
+    std::free(pointer);
+}
+
+namespace vkr::microbench {
+    auto getAllocationCount() -> uint64_t {
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+
+    auto writeGridModel(const std::filesystem::path& path, size_t side) -> void {
+        std::ofstream file(path);
+        if (!file) {
+            throw std::runtime_error(fmt::format("Couldn't write {}", path.string()));
+        }
+
+        float step = 1.0f / static_cast<float>(side - 1);
+        for (size_t y = 0; y < side; ++y) {
+            for (size_t x = 0; x < side; ++x) {
+                float u = static_cast<float>(x) * step;
+                float v = static_cast<float>(y) * step;
+                file << fmt::format("v {:.6f} {:.6f} {:.6f}\n", u, v, std::sin(u * 12.0f) * std::cos(v * 12.0f) * 0.1f);
+                file << fmt::format("vt {:.6f} {:.6f}\n", u, v);
+            }
+        }
+
+        for (size_t y = 0; y + 1 < side; ++y) {
+            for (size_t x = 0; x + 1 < side; ++x) {
+                size_t a = y * side + x + 1;
+                size_t b = a + 1;
+                size_t c = a + side;
+                size_t d = c + 1;
+                file << fmt::format("f {0}/{0} {1}/{1} {2}/{2}\nf {2}/{2} {1}/{1} {3}/{3}\n", a, b, c, d);
+            }
+        }
+    }
+
+    auto writeNoiseTexture(const std::filesystem::path& path, size_t side) -> void {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error(fmt::format("Couldn't write {}", path.string()));
+        }
+
+        file << fmt::format("P6\n{} {}\n255\n", side, side);
+
+        std::vector<uint8_t> row(side * 3);
+        uint32_t state = 0x9e3779b9u;
+        for (size_t y = 0; y < side; ++y) {
+            for (uint8_t& value : row) {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                value = static_cast<uint8_t>(state);
+            }
+            file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+        }
+    }
+
+    namespace {
+        auto benchModel(std::vector<Result>& results, const std::string& label, const std::filesystem::path& path) -> void {
+            std::string file = path.string();
+            auto fileBytes = static_cast<double>(std::filesystem::file_size(path));
+
+            data::Model model(file.c_str());
+            auto vertexCount = static_cast<double>(model.vertices.size());
+            auto indexCount = static_cast<double>(model.indices.size());
+
+            results.push_back(measure(fmt::format("Model::Model {}", label), indexCount, fileBytes, [&]() {
+                data::Model loaded(file.c_str(), false);
+                if (loaded.indices.empty()) {
+                    throw std::runtime_error(fmt::format("{} has no faces", file));
+                }
+            }));
+
+            results.push_back(measure(fmt::format("Model::Model cached {}", label), indexCount, fileBytes, [&]() {
+                data::Model loaded(file.c_str());
+                if (loaded.indices.size() != model.indices.size()) {
+                    throw std::runtime_error(fmt::format("The cache of {} doesn't match the source", file));
+                }
+            }));
+
+            results.push_back(measure(fmt::format("optimize::optimizeModel {}", label), indexCount / 3.0, 0.0, [&]() {
+                data::Model copy = model;
+                optimize::optimizeModel(copy);
+            }));
+
+            results.push_back(measure(fmt::format("Model::buildLods {}", label), indexCount / 3.0, 0.0, [&]() {
+                data::Model copy = model;
+                copy.buildLods(data::LodOptions());
+            }));
+
+            // The device half of pushModel needs a GPU; this covers its CPU work: mesh records, meshlets and packing into
+            // staging, for a renderer that holds nothing else.
+            std::vector<data::PackedVertex> packedVertices;
+            std::vector<uint32_t> packedIndices;
+            results.push_back(measure(fmt::format("pushModel (cpu) {}", label), vertexCount, vertexCount * sizeof(data::Vertex), [&]() {
+                data::ModelStore store;
+                data::appendModel(store, model);
+                packedVertices.resize(store.model.vertices.size());
+                packedIndices.resize(store.model.indices.size());
+                data::packVertices(store, 0, store.model.vertices.size(), packedVertices.data());
+                data::packIndices(store, 0, store.model.indices.size(), packedIndices.data());
+            }));
+        }
+
+        // The hash Model::Model used before hash::Table, kept as the baseline for the dedup benchmarks.
+        struct LegacyVertexHash {
+            auto operator()(const data::Vertex& vertex) const -> size_t {
+                return ((std::hash<glm::vec3>()(vertex.position) ^ (std::hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^ (std::hash<glm::vec2>()(vertex.textureCoordinates) << 1);
+            }
+        };
+
+        auto benchDedup(std::vector<Result>& results, const std::string& label, const std::filesystem::path& path) -> void {
+            std::string file = path.string();
+            data::Model model(file.c_str());
+
+            std::vector<data::Vertex> corners;
+            corners.reserve(model.indices.size());
+            for (uint32_t index : model.indices) {
+                corners.push_back(model.vertices[index]);
+            }
+
+            auto count = static_cast<double>(corners.size());
+            auto bytes = count * sizeof(data::Vertex);
+
+            results.push_back(measure(fmt::format("dedup unordered_map {}", label), count, bytes, [&]() {
+                std::unordered_map<data::Vertex, uint32_t, LegacyVertexHash> uniqueVertices;
+                std::vector<uint32_t> indices;
+                indices.reserve(corners.size());
+                for (const data::Vertex& vertex : corners) {
+                    if (uniqueVertices.count(vertex) == 0) {
+                        uniqueVertices[vertex] = static_cast<uint32_t>(uniqueVertices.size());
+                    }
+                    indices.push_back(uniqueVertices[vertex]);
+                }
+            }));
+
+            results.push_back(measure(fmt::format("dedup hash::Table {}", label), count, bytes, [&]() {
+                hash::Table<data::Vertex, uint32_t> uniqueVertices(corners.size());
+                std::vector<uint32_t> indices;
+                indices.reserve(corners.size());
+                for (const data::Vertex& vertex : corners) {
+                    indices.push_back(uniqueVertices.tryEmplace(vertex, static_cast<uint32_t>(uniqueVertices.getSize())).first);
+                }
+            }));
+        }
+
+        auto benchTexture(std::vector<Result>& results, const std::string& label, const std::filesystem::path& path) -> void {
+            std::string file = path.string();
+
+            data::Texture texture(file.c_str(), false);
+            auto pixels = static_cast<double>(texture.getDimentions().x) * static_cast<double>(texture.getDimentions().y);
+
+            results.push_back(measure(fmt::format("Texture::Texture {}", label), pixels, static_cast<double>(texture.getSize()), [&]() {
+                data::Texture loaded(file.c_str(), false);
+            }));
+
+            data::Texture cached(file.c_str());
+            results.push_back(measure(fmt::format("Texture::Texture {} cached", label), pixels, static_cast<double>(cached.getSize()), [&]() {
+                data::Texture loaded(file.c_str());
+            }));
+        }
+
+        auto benchTranscode(std::vector<Result>& results, const std::string& label, const std::filesystem::path& path, const std::filesystem::path& directory) -> void {
+            data::Texture texture(path.string().c_str(), false);
+            auto pixels = static_cast<double>(texture.getDimentions().x) * static_cast<double>(texture.getDimentions().y);
+
+            parallel::ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+            for (mip::Filter filter : { mip::Filter::eBox, mip::Filter::eKaiser }) {
+                results.push_back(measure(fmt::format("mip::buildMipChain {} {}", mip::getFilterName(filter), label), pixels, static_cast<double>(texture.getSize()), [&]() {
+                    data::Texture mips = mip::buildMipChain(pool, texture, filter);
+                }));
+            }
+
+            data::Texture mips = mip::buildMipChain(pool, texture);
+            for (auto [name, format] : { std::pair("bc1", vk::Format::eBc1RgbSrgbBlock), std::pair("bc7", vk::Format::eBc7SrgbBlock) }) {
+                results.push_back(measure(fmt::format("bc::compress {} {}", name, label), pixels, static_cast<double>(mips.getSize()), [&]() {
+                    data::Texture compressed = bc::compress(pool, mips, format);
+                }));
+            }
+
+            std::string file = (directory / path.filename()).replace_extension(".ktx2").string();
+            data::Texture compressed = bc::compress(pool, mips, vk::Format::eBc7SrgbBlock);
+            ktx::write(file.c_str(), compressed);
+            results.push_back(measure(fmt::format("Texture::Texture {} ktx2", label), pixels, static_cast<double>(compressed.getSize()), [&]() {
+                data::Texture loaded(file.c_str());
+            }));
+        }
+
+        auto print(const std::vector<Result>& results) -> void {
+            fmt::print("{:<40} {:>10} {:>12} {:>14} {:>10} {:>12}\n", "benchmark", "iterations", "ms/iter", "items/s", "MB/s", "allocs/iter");
+            for (const Result& result : results) {
+                fmt::print("{:<40} {:>10} {:>12.4f} {:>14.0f} {:>10.1f} {:>12.1f}\n",
+                    result.name,
+                    result.iterations,
+                    result.seconds * 1e3,
+                    result.items / result.seconds,
+                    result.bytes / result.seconds / (1024.0 * 1024.0),
+                    result.allocations
+                );
+            }
+        }
+    }
+
+    auto run(std::span<char*> arguments) -> int {
+        std::string filter;
+        if (!arguments.empty()) {
+            filter = arguments[0];
+        }
+
+        try {
+            std::filesystem::path directory = std::filesystem::temp_directory_path() / "vkr-microbench";
+            std::filesystem::create_directories(directory);
+
+            std::vector<Result> results;
+            auto enabled = [&](std::string_view name) {
+                return filter.empty() || name.find(filter) != std::string_view::npos;
+            };
+
+            if (enabled("model")) {
+                benchModel(results, "room.obj", "models/room.obj");
+                benchModel(results, "orange.obj", "models/orange.obj");
+                for (size_t side : { 32, 128, 512 }) {
+                    std::filesystem::path path = directory / fmt::format("grid{}.obj", side);
+                    writeGridModel(path, side);
+                    benchModel(results, fmt::format("grid {}x{}", side, side), path);
+                }
+            }
+
+            if (enabled("dedup")) {
+                benchDedup(results, "room.obj", "models/room.obj");
+                benchDedup(results, "orange.obj", "models/orange.obj");
+                for (size_t side : { 128, 512 }) {
+                    std::filesystem::path path = directory / fmt::format("grid{}.obj", side);
+                    writeGridModel(path, side);
+                    benchDedup(results, fmt::format("grid {}x{}", side, side), path);
+                }
+            }
+
+            if (enabled("texture")) {
+                benchTexture(results, "room.png", "textures/room.png");
+                benchTexture(results, "orange.jpg", "textures/orange.jpg");
+                for (size_t side : { 256, 1024, 2048 }) {
+                    std::filesystem::path path = directory / fmt::format("noise{}.ppm", side);
+                    writeNoiseTexture(path, side);
+                    benchTexture(results, fmt::format("noise {}x{}", side, side), path);
+                }
+            }
+
+            if (enabled("transcode")) {
+                benchTranscode(results, "room.png", "textures/room.png", directory);
+                std::filesystem::path path = directory / "noise1024.ppm";
+                writeNoiseTexture(path, 1024);
+                benchTranscode(results, "noise 1024x1024", path, directory);
+            }
+
+            if (enabled("meta")) {
+                // The two layouts the graphics pipeline builds its vertex input from.
+                results.push_back(measure("meta::getAttributeDescriptions<PackedVertex>", 1000.0, 0.0, []() {
+                    for (size_t i = 0; i < 1000; ++i) {
+                        auto descriptions = meta::getAttributeDescriptions<data::PackedVertex>();
+                        volatile auto format = descriptions[i % descriptions.size()].format;
+                        static_cast<void>(format);
+                    }
+                }));
+
+                results.push_back(measure("meta::getAttributeDescriptions<Instance>", 1000.0, 0.0, []() {
+                    for (size_t i = 0; i < 1000; ++i) {
+                        auto descriptions = meta::getAttributeDescriptions<data::Instance>();
+                        volatile auto format = descriptions[i % descriptions.size()].format;
+                        static_cast<void>(format);
+                    }
+                }));
+            }
+
+            print(results);
+        }
+        catch (const std::exception& e) {
+            spdlog::error(e.what());
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    return vkr::microbench::run(std::span<char*>(argv + 1, static_cast<size_t>(argc - 1)));
+}
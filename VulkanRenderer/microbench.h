@@ -0,0 +1,48 @@
+#pragma once
+#include "meta.h"
+#include "data.h"
+
+namespace vkr::microbench {
+    struct Result {
+        std::string name;
+        size_t iterations = 0;
+        double seconds = 0.0;
+        double allocations = 0.0;
+        double items = 0.0;
+        double bytes = 0.0;
+    };
+
+    auto getAllocationCount() -> uint64_t;
+
+    template <class F>
+    auto measure(std::string name, double items, double bytes, F&& function) -> Result {
+        using Clock = std::chrono::steady_clock;
+        constexpr size_t minIterations = 3;
+        constexpr std::chrono::milliseconds minDuration(500);
+
+        function();
+
+        Result result;
+        result.name = std::move(name);
+
+        uint64_t allocations = getAllocationCount();
+        auto start = Clock::now();
+        auto end = start;
+        while (result.iterations < minIterations || end - start < minDuration) {
+            function();
+            result.iterations++;
+            end = Clock::now();
+        }
+
+        auto iterations = static_cast<double>(result.iterations);
+        result.seconds = std::chrono::duration<double>(end - start).count() / iterations;
+        result.allocations = static_cast<double>(getAllocationCount() - allocations) / iterations;
+        result.items = items;
+        result.bytes = bytes;
+        return result;
+    }
+
+    auto writeGridModel(const std::filesystem::path& path, size_t side) -> void;
+    auto writeNoiseTexture(const std::filesystem::path& path, size_t side) -> void;
+    auto run(std::span<char*> arguments) -> int;
+}
@@ -0,0 +1,333 @@
+#include "mip.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace vkr::mip {
+    namespace {
+        constexpr int32_t rowsPerTask = 16;
+        constexpr float kaiserRadius = 2.0f;
+        constexpr float kaiserAlpha = 4.0f;
+
+#if defined(__SSE2__) || defined(_M_X64)
+        using Float4 = __m128;
+
+        auto load(const float* source) -> Float4 {
+            return _mm_loadu_ps(source);
+        }
+
+        auto store(float* destination, Float4 value) -> void {
+            _mm_storeu_ps(destination, value);
+        }
+
+        auto splat(float value) -> Float4 {
+            return _mm_set1_ps(value);
+        }
+
+        auto multiplyAdd(Float4 sum, Float4 a, Float4 b) -> Float4 {
+            return _mm_add_ps(sum, _mm_mul_ps(a, b));
+        }
+
+        auto clampUnit(Float4 value) -> Float4 {
+            return _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        }
+
+        auto toIndices(Float4 value) -> std::array<int32_t, 4> {
+            std::array<int32_t, 4> indices;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(indices.data()), _mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(65535.0f))));
+            return indices;
+        }
+#else
+        struct Float4 {
+            std::array<float, 4> values;
+        };
+
+        auto load(const float* source) -> Float4 {
+            Float4 value;
+            memcpy(value.values.data(), source, sizeof(value.values));
+            return value;
+        }
+
+        auto store(float* destination, Float4 value) -> void {
+            memcpy(destination, value.values.data(), sizeof(value.values));
+        }
+
+        auto splat(float value) -> Float4 {
+            return { { value, value, value, value } };
+        }
+
+        auto multiplyAdd(Float4 sum, Float4 a, Float4 b) -> Float4 {
+            for (size_t c = 0; c < 4; ++c) {
+                sum.values[c] += a.values[c] * b.values[c];
+            }
+            return sum;
+        }
+
+        auto clampUnit(Float4 value) -> Float4 {
+            for (float& v : value.values) {
+                v = std::clamp(v, 0.0f, 1.0f);
+            }
+            return value;
+        }
+
+        auto toIndices(Float4 value) -> std::array<int32_t, 4> {
+            std::array<int32_t, 4> indices;
+            for (size_t c = 0; c < 4; ++c) {
+                indices[c] = static_cast<int32_t>(value.values[c] * 65535.0f + 0.5f);
+            }
+            return indices;
+        }
+#endif
+
+        // Decoding goes through a table per byte value, encoding through a table over 16-bit linear values, which is
+        // finer than the steepest part of the sRGB curve.
+        struct Transfer {
+            std::array<float, 256> decode = {};
+            std::array<uint8_t, 65536> encode = {};
+        };
+
+        auto buildTransfer(bool srgb) -> Transfer {
+            Transfer transfer;
+            for (size_t i = 0; i < transfer.decode.size(); ++i) {
+                float c = static_cast<float>(i) / 255.0f;
+                transfer.decode[i] = !srgb ? c : c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            for (size_t i = 0; i < transfer.encode.size(); ++i) {
+                float c = static_cast<float>(i) / 65535.0f;
+                c = !srgb ? c : c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+                transfer.encode[i] = static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+            }
+            return transfer;
+        }
+
+        auto getTransfer(bool srgb) -> const Transfer& {
+            static const Transfer srgbTransfer = buildTransfer(true);
+            static const Transfer linearTransfer = buildTransfer(false);
+            return srgb ? srgbTransfer : linearTransfer;
+        }
+
+        auto besselI0(float x) -> float {
+            float sum = 1.0f;
+            float term = 1.0f;
+            for (int32_t k = 1; k < 32 && term > sum * 1e-8f; ++k) {
+                term *= (x * 0.5f / static_cast<float>(k)) * (x * 0.5f / static_cast<float>(k));
+                sum += term;
+            }
+            return sum;
+        }
+
+        // A Kaiser windowed sinc, with x in destination texels.
+        auto getKaiserWeight(float x) -> float {
+            if (std::abs(x) >= kaiserRadius) {
+                return 0.0f;
+            }
+            float sinc = x == 0.0f ? 1.0f : std::sin(glm::pi<float>() * x) / (glm::pi<float>() * x);
+            float t = x / kaiserRadius;
+            return sinc * besselI0(kaiserAlpha * std::sqrt(1.0f - t * t)) / besselI0(kaiserAlpha);
+        }
+
+        // Every destination texel reads taps consecutive source texels starting at first. Box weights are the exact
+        // coverage of each source texel, so odd sizes are filtered correctly too.
+        struct Kernel {
+            int32_t taps = 0;
+            std::vector<int32_t> first;
+            std::vector<float> weights;
+        };
+
+        auto buildKernel(int32_t sourceSize, int32_t size, Filter filter) -> Kernel {
+            float scale = static_cast<float>(sourceSize) / static_cast<float>(size);
+            float radius = (filter == Filter::eBox ? 0.5f : kaiserRadius) * scale;
+
+            Kernel kernel;
+            kernel.taps = static_cast<int32_t>(std::ceil(radius * 2.0f)) + 1;
+            kernel.first.resize(size);
+            kernel.weights.resize(static_cast<size_t>(size) * kernel.taps);
+
+            for (int32_t i = 0; i < size; ++i) {
+                float center = (static_cast<float>(i) + 0.5f) * scale;
+                kernel.first[i] = static_cast<int32_t>(std::floor(center - radius));
+
+                float* weights = kernel.weights.data() + static_cast<size_t>(i) * kernel.taps;
+                float sum = 0.0f;
+                for (int32_t k = 0; k < kernel.taps; ++k) {
+                    auto texel = static_cast<float>(kernel.first[i] + k);
+                    if (filter == Filter::eBox) {
+                        weights[k] = std::max(std::min(texel + 1.0f, center + radius) - std::max(texel, center - radius), 0.0f);
+                    }
+                    else {
+                        weights[k] = getKaiserWeight((texel + 0.5f - center) / scale);
+                    }
+                    sum += weights[k];
+                }
+                for (int32_t k = 0; k < kernel.taps; ++k) {
+                    weights[k] /= sum;
+                }
+            }
+            return kernel;
+        }
+
+        // source points at texel 0 of a row padded by clamped texels on both sides.
+        auto filterRow(const float* source, const Kernel& kernel, int32_t size, float* destination) -> void {
+            for (int32_t x = 0; x < size; ++x) {
+                const float* texels = source + static_cast<ptrdiff_t>(kernel.first[x]) * 4;
+                const float* weights = kernel.weights.data() + static_cast<size_t>(x) * kernel.taps;
+                int32_t k = 0;
+#if defined(__AVX__)
+                __m256 wide = _mm256_setzero_ps();
+                for (; k + 2 <= kernel.taps; k += 2) {
+                    __m256 weight = _mm256_set_m128(_mm_set1_ps(weights[k + 1]), _mm_set1_ps(weights[k]));
+                    wide = _mm256_add_ps(wide, _mm256_mul_ps(_mm256_loadu_ps(texels + k * 4), weight));
+                }
+                Float4 sum = _mm_add_ps(_mm256_castps256_ps128(wide), _mm256_extractf128_ps(wide, 1));
+#else
+                Float4 sum = splat(0.0f);
+#endif
+                for (; k < kernel.taps; ++k) {
+                    sum = multiplyAdd(sum, load(texels + k * 4), splat(weights[k]));
+                }
+                store(destination + static_cast<size_t>(x) * 4, sum);
+            }
+        }
+
+        auto filterColumn(std::span<const float*> rows, const float* weights, int32_t size, float* destination) -> void {
+            int32_t x = 0;
+#if defined(__AVX__)
+            for (; x + 2 <= size; x += 2) {
+                __m256 sum = _mm256_setzero_ps();
+                for (size_t k = 0; k < rows.size(); ++k) {
+                    sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(rows[k] + x * 4), _mm256_set1_ps(weights[k])));
+                }
+                _mm256_storeu_ps(destination + x * 4, sum);
+            }
+#endif
+            for (; x < size; ++x) {
+                Float4 sum = splat(0.0f);
+                for (size_t k = 0; k < rows.size(); ++k) {
+                    sum = multiplyAdd(sum, load(rows[k] + x * 4), splat(weights[k]));
+                }
+                store(destination + static_cast<size_t>(x) * 4, sum);
+            }
+        }
+
+        // Clamps the row in place, so the next level is filtered from exactly what this one stores.
+        auto encodeRow(float* row, int32_t size, const Transfer& color, uint8_t* destination) -> void {
+            const Transfer& alpha = getTransfer(false);
+            for (int32_t x = 0; x < size; ++x) {
+                Float4 value = clampUnit(load(row + x * 4));
+                store(row + x * 4, value);
+
+                std::array<int32_t, 4> indices = toIndices(value);
+                destination[x * 4 + 0] = color.encode[indices[0]];
+                destination[x * 4 + 1] = color.encode[indices[1]];
+                destination[x * 4 + 2] = color.encode[indices[2]];
+                destination[x * 4 + 3] = alpha.encode[indices[3]];
+            }
+        }
+    }
+
+    auto getLevelCount(glm::ivec2 size) -> uint32_t {
+        return static_cast<uint32_t>(std::floor(std::log2(std::max(size.x, size.y)))) + 1;
+    }
+
+    auto getFilterName(Filter filter) -> std::string_view {
+        return filter == Filter::eBox ? "box" : "kaiser";
+    }
+
+    auto buildMipChain(const data::Texture& texture, Filter filter) -> data::Texture {
+        static parallel::ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+        return buildMipChain(pool, texture, filter);
+    }
+
+    // Builds every level below the texture's first on the CPU, so the result can be compressed or uploaded as is.
+    // Filtering happens on linear floats and each level is filtered from the unquantized one above it. The rows of a
+    // level are split across the pool, and each task filters the source rows it needs horizontally, then vertically.
+    auto buildMipChain(parallel::ThreadPool& pool, const data::Texture& texture, Filter filter) -> data::Texture {
+        if (texture.getFormat() != vk::Format::eR8G8B8A8Srgb && texture.getFormat() != vk::Format::eR8G8B8A8Unorm) {
+            throw std::runtime_error(fmt::format("Can't build mipmaps for {} textures", vk::to_string(texture.getFormat())));
+        }
+        const Transfer& color = getTransfer(texture.getFormat() == vk::Format::eR8G8B8A8Srgb);
+        const Transfer& alpha = getTransfer(false);
+
+        glm::ivec2 size = texture.getDimentions();
+        uint32_t levelCount = getLevelCount(size);
+
+        std::vector<data::TextureLevel> levels(levelCount);
+        size_t total = 0;
+        for (uint32_t level = 0; level < levelCount; ++level) {
+            glm::ivec2 levelSize = texture.getLevelDimentions(level);
+            levels[level] = { total, static_cast<size_t>(levelSize.x) * static_cast<size_t>(levelSize.y) * 4 };
+            total += levels[level].size;
+        }
+
+        std::vector<uint8_t> pixels(total);
+        memcpy(pixels.data(), texture.getPixels() + texture.getLevels()[0].offset, levels[0].size);
+
+        std::vector<float> source;
+        std::vector<float> next;
+        for (uint32_t level = 1; level < levelCount; ++level) {
+            glm::ivec2 sourceSize = texture.getLevelDimentions(level - 1);
+            glm::ivec2 levelSize = texture.getLevelDimentions(level);
+            Kernel horizontal = buildKernel(sourceSize.x, levelSize.x, filter);
+            Kernel vertical = buildKernel(sourceSize.y, levelSize.y, filter);
+            int32_t padding = horizontal.taps + 1;
+
+            bool keep = level + 1 < levelCount;
+            next.resize(keep ? static_cast<size_t>(levelSize.x) * levelSize.y * 4 : 0);
+
+            const uint8_t* sourcePixels = pixels.data() + levels[level - 1].offset;
+            uint8_t* destination = pixels.data() + levels[level].offset;
+
+            auto taskCount = static_cast<size_t>((levelSize.y + rowsPerTask - 1) / rowsPerTask);
+            pool.run(taskCount, [&](size_t task) {
+                int32_t begin = static_cast<int32_t>(task) * rowsPerTask;
+                int32_t end = std::min(begin + rowsPerTask, levelSize.y);
+                int32_t low = std::clamp(vertical.first[begin], 0, sourceSize.y - 1);
+                int32_t high = std::clamp(vertical.first[end - 1] + vertical.taps - 1, 0, sourceSize.y - 1);
+                size_t rowSize = static_cast<size_t>(levelSize.x) * 4;
+
+                std::vector<float> padded(static_cast<size_t>(sourceSize.x + padding * 2) * 4);
+                std::vector<float> filtered(static_cast<size_t>(high - low + 1) * rowSize);
+                std::vector<float> scratch(keep ? 0 : rowSize);
+                std::vector<const float*> rows(vertical.taps);
+
+                for (int32_t y = low; y <= high; ++y) {
+                    float* texels = padded.data() + padding * 4;
+                    if (source.empty()) {
+                        const uint8_t* row = sourcePixels + static_cast<size_t>(y) * sourceSize.x * 4;
+                        for (int32_t x = 0; x < sourceSize.x; ++x) {
+                            texels[x * 4 + 0] = color.decode[row[x * 4 + 0]];
+                            texels[x * 4 + 1] = color.decode[row[x * 4 + 1]];
+                            texels[x * 4 + 2] = color.decode[row[x * 4 + 2]];
+                            texels[x * 4 + 3] = alpha.decode[row[x * 4 + 3]];
+                        }
+                    }
+                    else {
+                        memcpy(texels, source.data() + static_cast<size_t>(y) * sourceSize.x * 4, static_cast<size_t>(sourceSize.x) * 4 * sizeof(float));
+                    }
+                    for (int32_t x = 1; x <= padding; ++x) {
+                        memcpy(texels - x * 4, texels, 4 * sizeof(float));
+                        memcpy(texels + (sourceSize.x - 1 + x) * 4, texels + (sourceSize.x - 1) * 4, 4 * sizeof(float));
+                    }
+                    filterRow(texels, horizontal, levelSize.x, filtered.data() + static_cast<size_t>(y - low) * rowSize);
+                }
+
+                for (int32_t y = begin; y < end; ++y) {
+                    for (int32_t k = 0; k < vertical.taps; ++k) {
+                        int32_t row = std::clamp(vertical.first[y] + k, 0, sourceSize.y - 1);
+                        rows[k] = filtered.data() + static_cast<size_t>(row - low) * rowSize;
+                    }
+                    float* row = keep ? next.data() + static_cast<size_t>(y) * rowSize : scratch.data();
+                    filterColumn(rows, vertical.weights.data() + static_cast<size_t>(y) * vertical.taps, levelSize.x, row);
+                    encodeRow(row, levelSize.x, color, destination + static_cast<size_t>(y) * rowSize);
+                }
+            });
+
+            std::swap(source, next);
+        }
+
+        return data::Texture(texture.getFormat(), size, std::move(pixels), std::move(levels));
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "data.h"
+#include "parallel.h"
+
+namespace vkr::mip {
+    enum class Filter {
+        eBox,
+        eKaiser
+    };
+
+    constexpr Filter defaultFilter = Filter::eKaiser;
+
+    auto getLevelCount(glm::ivec2 size) -> uint32_t;
+    auto getFilterName(Filter filter) -> std::string_view;
+    auto buildMipChain(const data::Texture& texture, Filter filter = defaultFilter) -> data::Texture;
+    auto buildMipChain(parallel::ThreadPool& pool, const data::Texture& texture, Filter filter = defaultFilter) -> data::Texture;
+}
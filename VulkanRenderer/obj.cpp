@@ -0,0 +1,256 @@
+#include "obj.h"
+#include "io.h"
+
+namespace vkr::obj {
+    namespace {
+        constexpr size_t minChunkSize = 1 << 20;
+
+        struct RawIndex {
+            int32_t value = 0;
+            bool relative = false;
+        };
+
+        struct RawCorner {
+            RawIndex position;
+            std::optional<RawIndex> texcoord;
+        };
+
+        struct Chunk {
+            std::string_view text;
+            std::vector<glm::vec3> positions;
+            std::vector<glm::vec2> texcoords;
+            std::vector<RawCorner> corners;
+            std::vector<uint32_t> faceSizes;
+            std::vector<Corner> triangles;
+            size_t positionBase = 0;
+            size_t texcoordBase = 0;
+        };
+
+        auto isSpace(char c) -> bool {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        auto skipSpaces(const char* it, const char* end) -> const char* {
+            while (it != end && isSpace(*it)) {
+                ++it;
+            }
+            return it;
+        }
+
+        auto parseFloat(const char*& it, const char* end) -> float {
+            it = skipSpaces(it, end);
+            if (it != end && *it == '+') {
+                ++it;
+            }
+
+            double value = 0.0;
+            auto [next, error] = std::from_chars(it, end, value);
+            if (error != std::errc()) {
+                return 0.0f;
+            }
+            it = next;
+            return static_cast<float>(value);
+        }
+
+        auto parseIndex(const char*& it, const char* end, size_t count) -> std::optional<RawIndex> {
+            int32_t value = 0;
+            auto [next, error] = std::from_chars(it, end, value);
+            if (error != std::errc()) {
+                return std::nullopt;
+            }
+            it = next;
+
+            if (value > 0) {
+                return RawIndex { value - 1, false };
+            }
+            if (value < 0) {
+                return RawIndex { static_cast<int32_t>(count) + value, true };
+            }
+            throw std::runtime_error("OBJ: index 0 is not valid");
+        }
+
+        auto parseFace(Chunk& chunk, const char* it, const char* end) -> void {
+            uint32_t size = 0;
+
+            while (true) {
+                it = skipSpaces(it, end);
+                if (it == end) {
+                    break;
+                }
+
+                std::optional<RawIndex> position = parseIndex(it, end, chunk.positions.size());
+                if (!position) {
+                    break;
+                }
+
+                RawCorner corner;
+                corner.position = *position;
+
+                if (it != end && *it == '/') {
+                    ++it;
+                    if (it != end && *it != '/') {
+                        corner.texcoord = parseIndex(it, end, chunk.texcoords.size());
+                    }
+                    if (it != end && *it == '/') {
+                        ++it;
+                        int32_t normal = 0;
+                        it = std::from_chars(it, end, normal).ptr;
+                    }
+                }
+
+                chunk.corners.push_back(corner);
+                size++;
+            }
+
+            chunk.faceSizes.push_back(size);
+        }
+
+        auto parseChunk(Chunk& chunk) -> void {
+            const char* it = chunk.text.data();
+            const char* end = it + chunk.text.size();
+
+            while (it != end) {
+                const char* lineEnd = static_cast<const char*>(memchr(it, '\n', static_cast<size_t>(end - it)));
+                if (!lineEnd) {
+                    lineEnd = end;
+                }
+
+                const char* line = skipSpaces(it, lineEnd);
+                size_t length = static_cast<size_t>(lineEnd - line);
+
+                if (length >= 2 && line[0] == 'v' && isSpace(line[1])) {
+                    const char* cursor = line + 2;
+                    float x = parseFloat(cursor, lineEnd);
+                    float y = parseFloat(cursor, lineEnd);
+                    float z = parseFloat(cursor, lineEnd);
+                    chunk.positions.emplace_back(x, y, z);
+                }
+                else if (length >= 3 && line[0] == 'v' && line[1] == 't' && isSpace(line[2])) {
+                    const char* cursor = line + 3;
+                    float u = parseFloat(cursor, lineEnd);
+                    float v = parseFloat(cursor, lineEnd);
+                    chunk.texcoords.emplace_back(u, v);
+                }
+                else if (length >= 2 && line[0] == 'f' && isSpace(line[1])) {
+                    parseFace(chunk, line + 2, lineEnd);
+                }
+
+                it = lineEnd == end ? end : lineEnd + 1;
+            }
+        }
+
+        auto resolve(const RawIndex& index, size_t base, size_t count) -> uint32_t {
+            int64_t value = static_cast<int64_t>(index.value) + (index.relative ? static_cast<int64_t>(base) : 0);
+            if (value < 0 || static_cast<size_t>(value) >= count) {
+                throw std::runtime_error(fmt::format("OBJ: index {} is out of range", value + 1));
+            }
+            return static_cast<uint32_t>(value);
+        }
+
+        // Quads are split along their shorter diagonal like tinyobjloader does, larger polygons are fanned.
+        auto triangulate(Chunk& chunk, const Mesh& mesh) -> void {
+            std::vector<Corner> face;
+            size_t next = 0;
+
+            chunk.triangles.reserve(chunk.corners.size());
+
+            for (uint32_t size : chunk.faceSizes) {
+                face.clear();
+                for (uint32_t i = 0; i < size; ++i) {
+                    const RawCorner& raw = chunk.corners[next++];
+                    Corner corner;
+                    corner.position = resolve(raw.position, chunk.positionBase, mesh.positions.size());
+                    if (raw.texcoord) {
+                        corner.texcoord = resolve(*raw.texcoord, chunk.texcoordBase, mesh.texcoords.size());
+                    }
+                    face.push_back(corner);
+                }
+
+                if (size < 3) {
+                    continue;
+                }
+
+                if (size == 4) {
+                    float diagonal02 = glm::distance2(mesh.positions[face[0].position], mesh.positions[face[2].position]);
+                    float diagonal13 = glm::distance2(mesh.positions[face[1].position], mesh.positions[face[3].position]);
+                    if (diagonal02 < diagonal13) {
+                        chunk.triangles.insert(chunk.triangles.end(), { face[0], face[1], face[2], face[0], face[2], face[3] });
+                    }
+                    else {
+                        chunk.triangles.insert(chunk.triangles.end(), { face[0], face[1], face[3], face[1], face[2], face[3] });
+                    }
+                    continue;
+                }
+
+                for (uint32_t i = 2; i < size; ++i) {
+                    chunk.triangles.insert(chunk.triangles.end(), { face[0], face[i - 1], face[i] });
+                }
+            }
+        }
+
+        auto getThreadPool() -> parallel::ThreadPool& {
+            static parallel::ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+            return pool;
+        }
+    }
+
+    auto load(const char* file) -> Mesh {
+        io::file::Mapping mapping(file);
+        return parse(mapping.getData(), getThreadPool());
+    }
+
+    auto parse(std::string_view text, parallel::ThreadPool& pool) -> Mesh {
+        size_t chunkCount = std::clamp<size_t>(text.size() / minChunkSize, 1, pool.getThreadCount());
+        std::vector<Chunk> chunks(chunkCount);
+
+        size_t begin = 0;
+        for (size_t i = 0; i < chunkCount; ++i) {
+            size_t end = i + 1 == chunkCount ? text.size() : std::max(begin, text.size() * (i + 1) / chunkCount);
+            if (end < text.size()) {
+                size_t newline = text.find('\n', end);
+                end = newline == std::string_view::npos ? text.size() : newline + 1;
+            }
+            chunks[i].text = text.substr(begin, end - begin);
+            begin = end;
+        }
+
+        pool.run(chunkCount, [&](size_t i) {
+            parseChunk(chunks[i]);
+        });
+
+        Mesh mesh;
+        size_t positionCount = 0;
+        size_t texcoordCount = 0;
+        for (Chunk& chunk : chunks) {
+            chunk.positionBase = positionCount;
+            chunk.texcoordBase = texcoordCount;
+            positionCount += chunk.positions.size();
+            texcoordCount += chunk.texcoords.size();
+        }
+
+        mesh.positions.resize(positionCount);
+        mesh.texcoords.resize(texcoordCount);
+
+        pool.run(chunkCount, [&](size_t i) {
+            Chunk& chunk = chunks[i];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), mesh.positions.begin() + static_cast<ptrdiff_t>(chunk.positionBase));
+            std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), mesh.texcoords.begin() + static_cast<ptrdiff_t>(chunk.texcoordBase));
+        });
+
+        pool.run(chunkCount, [&](size_t i) {
+            triangulate(chunks[i], mesh);
+        });
+
+        size_t cornerCount = 0;
+        for (const Chunk& chunk : chunks) {
+            cornerCount += chunk.triangles.size();
+        }
+
+        mesh.corners.reserve(cornerCount);
+        for (const Chunk& chunk : chunks) {
+            mesh.corners.insert(mesh.corners.end(), chunk.triangles.begin(), chunk.triangles.end());
+        }
+
+        return mesh;
+    }
+}
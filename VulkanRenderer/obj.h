@@ -0,0 +1,18 @@
+#pragma once
+#include "parallel.h"
+
+namespace vkr::obj {
+    struct Corner {
+        uint32_t position = 0;
+        std::optional<uint32_t> texcoord;
+    };
+
+    struct Mesh {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec2> texcoords;
+        std::vector<Corner> corners;
+    };
+
+    auto load(const char* file) -> Mesh;
+    auto parse(std::string_view text, parallel::ThreadPool& pool) -> Mesh;
+}
@@ -0,0 +1,300 @@
+#include "optimize.h"
+
+namespace vkr::optimize {
+    namespace {
+        struct Adjacency {
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> triangles;
+        };
+
+        auto buildAdjacency(std::span<const uint32_t> indices, size_t vertexCount) -> Adjacency {
+            Adjacency adjacency;
+            adjacency.offsets.assign(vertexCount + 1, 0);
+            for (uint32_t index : indices) {
+                adjacency.offsets[index + 1]++;
+            }
+            for (size_t i = 0; i < vertexCount; ++i) {
+                adjacency.offsets[i + 1] += adjacency.offsets[i];
+            }
+
+            std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+            adjacency.triangles.resize(indices.size());
+            for (size_t i = 0; i < indices.size(); ++i) {
+                adjacency.triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+            return adjacency;
+        }
+
+        // FIFO cache; reset() flushes it without touching every timestamp.
+        struct Cache {
+            Cache(size_t vertexCount, uint32_t size) : timestamps(vertexCount, 0), size(size) {}
+
+            auto reset() -> void {
+                time += size + 1;
+            }
+
+            auto access(uint32_t vertex) -> bool {
+                if (time - timestamps[vertex] <= size) {
+                    return false;
+                }
+                timestamps[vertex] = time++;
+                return true;
+            }
+
+            std::vector<uint64_t> timestamps;
+            uint64_t time = std::numeric_limits<uint32_t>::max();
+            uint32_t size = 0;
+        };
+
+        auto getTriangleMisses(Cache& cache, std::span<const uint32_t> indices, size_t triangle) -> uint32_t {
+            uint32_t misses = 0;
+            for (size_t corner = 0; corner < 3; ++corner) {
+                misses += cache.access(indices[triangle * 3 + corner]) ? 1 : 0;
+            }
+            return misses;
+        }
+    }
+
+    auto getCacheStatistics(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize) -> CacheStatistics {
+        CacheStatistics statistics;
+        if (indices.empty() || vertexCount == 0) {
+            return statistics;
+        }
+
+        Cache cache(vertexCount, cacheSize);
+        std::vector<bool> used(vertexCount, false);
+        size_t misses = 0;
+        size_t usedCount = 0;
+
+        for (uint32_t index : indices) {
+            misses += cache.access(index) ? 1 : 0;
+            if (!used[index]) {
+                used[index] = true;
+                usedCount++;
+            }
+        }
+
+        statistics.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+        statistics.atvr = static_cast<float>(misses) / static_cast<float>(usedCount);
+        return statistics;
+    }
+
+    // Tipsify (Sander, Nehab and Barczak 2007): fan around a vertex, then pick the next one still likely in the cache.
+    auto optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize) -> void {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        Adjacency adjacency = buildAdjacency(indices, vertexCount);
+
+        std::vector<uint32_t> live(vertexCount);
+        for (size_t i = 0; i < vertexCount; ++i) {
+            live[i] = adjacency.offsets[i + 1] - adjacency.offsets[i];
+        }
+
+        std::vector<uint64_t> timestamps(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+
+        uint64_t time = cacheSize + 1;
+        size_t cursor = 0;
+
+        auto skipDeadEnd = [&]() -> std::optional<uint32_t> {
+            while (!deadEnds.empty()) {
+                uint32_t vertex = deadEnds.back();
+                deadEnds.pop_back();
+                if (live[vertex] > 0) {
+                    return vertex;
+                }
+            }
+            while (cursor < vertexCount) {
+                if (live[cursor] > 0) {
+                    return static_cast<uint32_t>(cursor);
+                }
+                cursor++;
+            }
+            return std::nullopt;
+        };
+
+        std::optional<uint32_t> fanning = skipDeadEnd();
+
+        while (fanning) {
+            candidates.clear();
+
+            for (uint32_t i = adjacency.offsets[*fanning]; i < adjacency.offsets[*fanning + 1]; ++i) {
+                uint32_t triangle = adjacency.triangles[i];
+                if (emitted[triangle]) {
+                    continue;
+                }
+
+                for (size_t corner = 0; corner < 3; ++corner) {
+                    uint32_t vertex = indices[triangle * 3 + corner];
+                    result.push_back(vertex);
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    live[vertex]--;
+                    if (time - timestamps[vertex] > cacheSize) {
+                        timestamps[vertex] = time++;
+                    }
+                }
+                emitted[triangle] = true;
+            }
+
+            std::optional<uint32_t> next;
+            int64_t best = -1;
+            for (uint32_t vertex : candidates) {
+                if (live[vertex] == 0) {
+                    continue;
+                }
+                int64_t priority = 0;
+                if (time - timestamps[vertex] + 2 * static_cast<uint64_t>(live[vertex]) <= cacheSize) {
+                    priority = static_cast<int64_t>(time - timestamps[vertex]);
+                }
+                if (priority > best) {
+                    best = priority;
+                    next = vertex;
+                }
+            }
+
+            fanning = next ? next : skipDeadEnd();
+        }
+
+        std::copy(result.begin(), result.end(), indices.begin());
+    }
+
+    // Splits the cache-ordered triangles into clusters that each keep close to the overall ACMR, then draws the
+    // clusters facing away from the mesh center first so they occlude the rest (Sander et al., "Fast triangle reordering").
+    auto optimizeOverdraw(std::span<uint32_t> indices, std::span<const data::Vertex> vertices, float threshold, uint32_t cacheSize) -> void {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        std::vector<size_t> hardBoundaries;
+        {
+            Cache cache(vertices.size(), cacheSize);
+            for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+                if (getTriangleMisses(cache, indices, triangle) == 3) {
+                    hardBoundaries.push_back(triangle);
+                }
+            }
+        }
+        hardBoundaries.push_back(triangleCount);
+
+        std::vector<size_t> clusters;
+        {
+            Cache cache(vertices.size(), cacheSize);
+            for (size_t i = 0; i + 1 < hardBoundaries.size(); ++i) {
+                size_t begin = hardBoundaries[i];
+                size_t end = hardBoundaries[i + 1];
+
+                cache.reset();
+                uint32_t totalMisses = 0;
+                for (size_t triangle = begin; triangle < end; ++triangle) {
+                    totalMisses += getTriangleMisses(cache, indices, triangle);
+                }
+                float target = static_cast<float>(totalMisses) / static_cast<float>(end - begin) * threshold;
+
+                cache.reset();
+                clusters.push_back(begin);
+                uint32_t misses = 0;
+                size_t start = begin;
+                for (size_t triangle = begin; triangle < end; ++triangle) {
+                    misses += getTriangleMisses(cache, indices, triangle);
+                    if (triangle + 1 < end && static_cast<float>(misses) / static_cast<float>(triangle + 1 - start) <= target) {
+                        clusters.push_back(triangle + 1);
+                        cache.reset();
+                        misses = 0;
+                        start = triangle + 1;
+                    }
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+
+        glm::vec3 meshCenter(0.0f);
+        float meshArea = 0.0f;
+        std::vector<glm::vec3> centers(clusters.size() - 1, glm::vec3(0.0f));
+        std::vector<glm::vec3> normals(clusters.size() - 1, glm::vec3(0.0f));
+
+        for (size_t cluster = 0; cluster + 1 < clusters.size(); ++cluster) {
+            float clusterArea = 0.0f;
+            for (size_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle) {
+                const glm::vec3& a = vertices[indices[triangle * 3 + 0]].position;
+                const glm::vec3& b = vertices[indices[triangle * 3 + 1]].position;
+                const glm::vec3& c = vertices[indices[triangle * 3 + 2]].position;
+
+                glm::vec3 normal = glm::cross(b - a, c - a);
+                float area = glm::length(normal);
+                glm::vec3 center = (a + b + c) / 3.0f;
+
+                centers[cluster] += center * area;
+                normals[cluster] += normal;
+                clusterArea += area;
+                meshCenter += center * area;
+                meshArea += area;
+            }
+            if (clusterArea > 0.0f) {
+                centers[cluster] /= clusterArea;
+            }
+        }
+
+        if (meshArea > 0.0f) {
+            meshCenter /= meshArea;
+        }
+
+        std::vector<float> sortKeys(centers.size());
+        for (size_t cluster = 0; cluster < centers.size(); ++cluster) {
+            float length = glm::length(normals[cluster]);
+            sortKeys[cluster] = length > 0.0f ? glm::dot(centers[cluster] - meshCenter, normals[cluster] / length) : 0.0f;
+        }
+
+        std::vector<size_t> order(centers.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return sortKeys[a] > sortKeys[b];
+        });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (size_t cluster : order) {
+            result.insert(result.end(), indices.begin() + static_cast<ptrdiff_t>(clusters[cluster] * 3), indices.begin() + static_cast<ptrdiff_t>(clusters[cluster + 1] * 3));
+        }
+
+        std::copy(result.begin(), result.end(), indices.begin());
+    }
+
+    auto optimizeVertexFetch(std::vector<data::Vertex>& vertices, std::span<uint32_t> indices) -> void {
+        constexpr uint32_t unused = std::numeric_limits<uint32_t>::max();
+
+        std::vector<uint32_t> remap(vertices.size(), unused);
+        std::vector<data::Vertex> result;
+        result.reserve(vertices.size());
+
+        for (uint32_t& index : indices) {
+            if (remap[index] == unused) {
+                remap[index] = static_cast<uint32_t>(result.size());
+                result.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        vertices = std::move(result);
+    }
+
+    auto optimizeModel(data::Model& model) -> Report {
+        Report report;
+        report.before = getCacheStatistics(model.indices, model.vertices.size());
+
+        optimizeVertexCache(model.indices, model.vertices.size());
+        optimizeOverdraw(model.indices, model.vertices);
+        optimizeVertexFetch(model.vertices, model.indices);
+
+        report.after = getCacheStatistics(model.indices, model.vertices.size());
+        return report;
+    }
+}
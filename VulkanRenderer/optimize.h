@@ -0,0 +1,23 @@
+#pragma once
+#include "data.h"
+
+namespace vkr::optimize {
+    struct CacheStatistics {
+        float acmr = 0.0f;
+        float atvr = 0.0f;
+    };
+
+    struct Report {
+        CacheStatistics before;
+        CacheStatistics after;
+    };
+
+    constexpr uint32_t cacheSize = 16;
+    constexpr float overdrawThreshold = 1.05f;
+
+    auto getCacheStatistics(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = optimize::cacheSize) -> CacheStatistics;
+    auto optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize = optimize::cacheSize) -> void;
+    auto optimizeOverdraw(std::span<uint32_t> indices, std::span<const data::Vertex> vertices, float threshold = overdrawThreshold, uint32_t cacheSize = optimize::cacheSize) -> void;
+    auto optimizeVertexFetch(std::vector<data::Vertex>& vertices, std::span<uint32_t> indices) -> void;
+    auto optimizeModel(data::Model& model) -> Report;
+}
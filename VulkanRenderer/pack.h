@@ -0,0 +1,23 @@
+#pragma once
+
+namespace vkr::pack {
+    struct Snorm16x4 {
+        int16_t x = 0;
+        int16_t y = 0;
+        int16_t z = 0;
+        int16_t w = 0;
+    };
+
+    struct Unorm16x2 {
+        uint16_t x = 0;
+        uint16_t y = 0;
+    };
+
+    inline auto toSnorm16(float value) -> int16_t {
+        return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    inline auto toUnorm16(float value) -> uint16_t {
+        return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    }
+}
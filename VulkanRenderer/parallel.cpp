@@ -0,0 +1,88 @@
+#include "parallel.h"
+
+namespace vkr::parallel {
+    ThreadPool::ThreadPool(size_t workerCount) {
+        for (size_t i = 0; i < workerCount; ++i) {
+            workers.emplace_back([this]() {
+                work();
+            });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    auto ThreadPool::getThreadCount() const -> size_t {
+        return workers.size() + 1;
+    }
+
+    auto ThreadPool::run(size_t count, void (*invoke)(void*, size_t), void* context) -> void {
+        if (count == 0) {
+            return;
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            this->invoke = invoke;
+            this->context = context;
+            this->count = count;
+            next = 0;
+            active = workers.size();
+            error = nullptr;
+            generation++;
+        }
+        wake.notify_all();
+
+        drain();
+
+        std::unique_lock lock(mutex);
+        done.wait(lock, [&]() { return active == 0; });
+
+        if (error) {
+            std::rethrow_exception(std::exchange(error, nullptr));
+        }
+    }
+
+    auto ThreadPool::work() -> void {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [&]() { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+
+            drain();
+
+            std::lock_guard lock(mutex);
+            if (--active == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+    auto ThreadPool::drain() -> void {
+        for (size_t index = next++; index < count; index = next++) {
+            try {
+                invoke(context, index);
+            }
+            catch (...) {
+                std::lock_guard lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+namespace vkr::parallel {
+    class ThreadPool {
+    public:
+        ThreadPool(size_t workerCount);
+        ThreadPool(const ThreadPool&) = delete;
+        ~ThreadPool();
+        auto getThreadCount() const -> size_t;
+        template <class F>
+        auto run(size_t count, F&& task) -> void {
+            auto invoke = [](void* context, size_t index) {
+                (*static_cast<std::remove_reference_t<F>*>(context))(index);
+            };
+            run(count, invoke, const_cast<void*>(static_cast<const void*>(std::addressof(task))));
+        }
+    private:
+        auto run(size_t count, void (*invoke)(void*, size_t), void* context) -> void;
+        auto work() -> void;
+        auto drain() -> void;
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        uint64_t generation = 0;
+        bool stopping = false;
+        void (*invoke)(void*, size_t) = nullptr;
+        void* context = nullptr;
+        size_t count = 0;
+        std::atomic<size_t> next = 0;
+        size_t active = 0;
+        std::exception_ptr error;
+    };
+}
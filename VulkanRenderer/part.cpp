@@ -2,6 +2,10 @@
 
 namespace vkr::part {
     BeginPart::BeginPart(api::RendererCreateInfo&& rendererCreateInfo) : rendererCreateInfo(std::move(rendererCreateInfo)) {
+        if (getCreateInfo().headless) {
+            return;
+        }
+
         glfw::glfwSetErrorCallback([](int code, const char* message) {
             throw std::runtime_error(fmt::format("GLFW: {}", message));
             });
@@ -16,7 +20,9 @@ namespace vkr::part {
     }
 
     BeginPart::~BeginPart() {
-        glfw::glfwTerminate();
+        if (!getCreateInfo().headless) {
+            glfw::glfwTerminate();
+        }
     }
 
     auto BeginPart::getCreateInfo() -> api::RendererCreateInfo& {
@@ -31,8 +37,11 @@ namespace vkr::part {
 
         bool useDebugger = getCreateInfo().debuggerMinimumLevel != api::DebuggerMinimunLevel::eDisabled;
 
-        extentions = []() {
+        extentions = [&]() {
             std::vector<const char*> result;
+            if (getCreateInfo().headless) {
+                return result;
+            }
             uint32_t count = 0;
             const char** result_ = glfw::glfwGetRequiredInstanceExtensions(&count);
             result.insert(result.end(), result_, result_ + static_cast<size_t>(count));
@@ -124,7 +133,11 @@ namespace vkr::part {
     ) {
         if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
             spdlog::error(callbackData->pMessage);
+#ifdef _MSC_VER
             __debugbreak();
+#else
+            raise(SIGTRAP);
+#endif
         }
 
         else if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
@@ -142,9 +155,15 @@ namespace vkr::part {
         return VK_FALSE;
     }
 
-    SurfacePart::SurfacePart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)), windowHandle(getCreateInfo().windowCreateInfo) {
+    SurfacePart::SurfacePart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
+        if (getCreateInfo().headless) {
+            return;
+        }
+
+        windowHandle.emplace(getCreateInfo().windowCreateInfo);
+
         VkSurfaceKHR surface_;
-        glfw::glfwCreateWindowSurface((VkInstance)(getInstance()), windowHandle.getWindowGLFW(), nullptr, &surface_);
+        glfw::glfwCreateWindowSurface((VkInstance)(getInstance()), windowHandle->getWindowGLFW(), nullptr, &surface_);
         vk::ObjectDestroy<vk::Instance, VULKAN_HPP_DEFAULT_DISPATCHER_TYPE> deleter(getInstance());
         surface = vk::UniqueSurfaceKHR(vk::SurfaceKHR(surface_), deleter);
     }
@@ -154,7 +173,10 @@ namespace vkr::part {
     }
 
     auto SurfacePart::getWindowHandle() -> io::WindowHandle& {
-        return windowHandle;
+        if (!windowHandle) {
+            throw std::runtime_error("Headless renderer has no window");
+        }
+        return *windowHandle;
     }
 
     PhysicalDevicePart::PhysicalDevicePart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
@@ -165,6 +187,23 @@ namespace vkr::part {
             if (devices.size() == 0) {
                 throw std::runtime_error("No physical devices with Vulkan support");
             }
+
+            // Devices that can't run the renderer are never offered to the selector.
+            std::string rejected;
+            std::erase_if(devices, [&](vk::PhysicalDevice candidate) {
+                std::string missing = getMissingFeatures(candidate);
+                if (missing.empty()) {
+                    return false;
+                }
+                std::string reason = fmt::format("{} lacks {}", candidate.getProperties().deviceName.data(), missing);
+                spdlog::info("Skipping {}", reason);
+                rejected += rejected.empty() ? reason : "; " + reason;
+                return true;
+            });
+
+            if (devices.size() == 0) {
+                throw std::runtime_error(fmt::format("No physical device supports the renderer: {}", rejected));
+            }
             else if (devices.size() == 1) {
                 device = devices.front();
             }
@@ -175,18 +214,22 @@ namespace vkr::part {
             }
         }
 
-        bool found = false;
-        for (auto& properties : device.enumerateDeviceExtensionProperties()) {
-            if ("VK_KHR_swapchain"s == properties.extensionName) {
-                found = true;
-                break;
+        bool headless = getCreateInfo().headless;
+
+        if (!headless) {
+            bool found = false;
+            for (auto& properties : device.enumerateDeviceExtensionProperties()) {
+                if ("VK_KHR_swapchain"s == properties.extensionName) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                throw std::runtime_error("Device doesn't support swapchain extension");
             }
-        }
-        if (!found) {
-            throw std::runtime_error("Device doesn't support swapchain extension");
-        }
 
-        extentions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+            extentions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
 
         std::vector<vk::QueueFamilyProperties> properties = device.getQueueFamilyProperties();
         bool foundGraphics = false;
@@ -197,7 +240,7 @@ namespace vkr::part {
                 queueFamilyIndices[0] = i;
                 foundGraphics = true;
             }
-            if (!foundPresent && device.getSurfaceSupportKHR(i, getSurface())) {
+            if (!foundPresent && !headless && device.getSurfaceSupportKHR(i, getSurface())) {
                 queueFamilyIndices[1] = i;
                 foundPresent = true;
             }
@@ -207,9 +250,56 @@ namespace vkr::part {
             throw std::runtime_error("Couldn't find graphics family queue index");
         }
 
-        if (!foundPresent) {
+        if (headless) {
+            queueFamilyIndices[1] = queueFamilyIndices[0];
+        }
+        else if (!foundPresent) {
             throw std::runtime_error("Couldn't find present family queue index");
         }
+
+        transferQueueFamilyIndex = [&]() {
+            std::optional<uint32_t> fallback;
+            for (uint32_t i = 0; i < static_cast<uint32_t>(properties.size()); ++i) {
+                vk::QueueFlags flags = properties[static_cast<size_t>(i)].queueFlags;
+                if (!(flags & vk::QueueFlagBits::eTransfer) || (flags & vk::QueueFlagBits::eGraphics)) {
+                    continue;
+                }
+                if (!(flags & vk::QueueFlagBits::eCompute)) {
+                    return i;
+                }
+                if (!fallback) {
+                    fallback = i;
+                }
+            }
+            return fallback.value_or(queueFamilyIndices[0]);
+        }();
+    }
+
+    // Every texture is sampled through one descriptor array indexed per instance, so descriptor indexing is required;
+    // there is no per-texture binding path for devices without it.
+    auto PhysicalDevicePart::getMissingFeatures(vk::PhysicalDevice device) -> std::string {
+        if (device.getProperties().apiVersion < VK_API_VERSION_1_2) {
+            return "Vulkan 1.2";
+        }
+
+        auto features = device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+        const vk::PhysicalDeviceFeatures& features10 = features.get<vk::PhysicalDeviceFeatures2>().features;
+        const vk::PhysicalDeviceVulkan12Features& features12 = features.get<vk::PhysicalDeviceVulkan12Features>();
+
+        std::string missing;
+        auto require = [&](vk::Bool32 supported, std::string_view name) {
+            if (!supported) {
+                missing += missing.empty() ? std::string(name) : fmt::format(", {}", name);
+            }
+        };
+
+        require(features10.samplerAnisotropy, "samplerAnisotropy");
+        require(features12.runtimeDescriptorArray, "runtimeDescriptorArray");
+        require(features12.descriptorBindingPartiallyBound, "descriptorBindingPartiallyBound");
+        require(features12.descriptorBindingSampledImageUpdateAfterBind, "descriptorBindingSampledImageUpdateAfterBind");
+        require(features12.descriptorBindingUpdateUnusedWhilePending, "descriptorBindingUpdateUnusedWhilePending");
+        require(features12.shaderSampledImageArrayNonUniformIndexing, "shaderSampledImageArrayNonUniformIndexing");
+        return missing;
     }
 
     auto PhysicalDevicePart::getPhysicalDevice() -> const vk::PhysicalDevice& {
@@ -228,26 +318,27 @@ namespace vkr::part {
         return queueFamilyIndices[1];
     }
 
+    auto PhysicalDevicePart::getTransferQueueFamilyIndex() -> uint32_t {
+        return transferQueueFamilyIndex;
+    }
+
     auto PhysicalDevicePart::getQueueFamilyIndices() -> const std::array<uint32_t, 2>& {
         return queueFamilyIndices;
     }
 
     PhysicalDeviceDataPart::PhysicalDeviceDataPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
-        surfaceFormats = getPhysicalDevice().getSurfaceFormatsKHR(getSurface());
-
-        if (surfaceFormats.empty()) {
-            throw std::runtime_error("No surface formats are available");
-        }
+        if (!getCreateInfo().headless) {
+            surfaceFormats = getPhysicalDevice().getSurfaceFormatsKHR(getSurface());
 
-        surfacePresentModes = getPhysicalDevice().getSurfacePresentModesKHR(getSurface());
+            if (surfaceFormats.empty()) {
+                throw std::runtime_error("No surface formats are available");
+            }
 
-        if (surfacePresentModes.empty()) {
-            throw std::runtime_error("No present modes are available");
-        }
+            surfacePresentModes = getPhysicalDevice().getSurfacePresentModesKHR(getSurface());
 
-        vk::PhysicalDeviceFeatures features = getPhysicalDevice().getFeatures();
-        if (!features.samplerAnisotropy) {
-            throw std::runtime_error("Physical device doesn't support anisotropic filtering");
+            if (surfacePresentModes.empty()) {
+                throw std::runtime_error("No present modes are available");
+            }
         }
 
         depthFormat = [&]() {
@@ -306,6 +397,10 @@ namespace vkr::part {
     }
 
     auto PhysicalDeviceDataPart::getCurrentExtent() -> vk::Extent2D {
+        if (getCreateInfo().headless) {
+            glm::ivec2 size = getCreateInfo().windowCreateInfo.size;
+            return vk::Extent2D(static_cast<uint32_t>(size.x), static_cast<uint32_t>(size.y));
+        }
         return getPhysicalDevice().getSurfaceCapabilitiesKHR(getSurface()).currentExtent;
     }
 
@@ -314,6 +409,7 @@ namespace vkr::part {
         std::unordered_set<uint32_t> uniqueQueueFamilyIndices;
         uniqueQueueFamilyIndices.insert(getGraphicsQueueFamilyIndex());
         uniqueQueueFamilyIndices.insert(getPresentQueueFamilyIndex());
+        uniqueQueueFamilyIndices.insert(getTransferQueueFamilyIndex());
 
         float queuePriority = 1.0f;
 
@@ -325,8 +421,22 @@ namespace vkr::part {
             queueCreateInfos.push_back(info);
         }
 
-        vk::PhysicalDeviceFeatures features;
-        features.samplerAnisotropy = true;
+        auto supported = getPhysicalDevice().getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+        drawIndirectCount = supported.get<vk::PhysicalDeviceFeatures2>().features.multiDrawIndirect && supported.get<vk::PhysicalDeviceVulkan12Features>().drawIndirectCount;
+
+        // PhysicalDevicePart only selects devices that support the descriptor indexing features below.
+        vk::PhysicalDeviceVulkan12Features features12;
+        features12.drawIndirectCount = drawIndirectCount;
+        features12.runtimeDescriptorArray = true;
+        features12.descriptorBindingPartiallyBound = true;
+        features12.descriptorBindingSampledImageUpdateAfterBind = true;
+        features12.descriptorBindingUpdateUnusedWhilePending = true;
+        features12.shaderSampledImageArrayNonUniformIndexing = true;
+
+        vk::PhysicalDeviceFeatures2 features;
+        features.features.samplerAnisotropy = true;
+        features.features.multiDrawIndirect = drawIndirectCount;
+        features.pNext = &features12;
 
         vk::DeviceCreateInfo info;
         info.queueCreateInfoCount = (uint32_t)(queueCreateInfos.size());
@@ -335,10 +445,12 @@ namespace vkr::part {
         info.ppEnabledLayerNames = getInstanceLayers().data();
         info.enabledExtensionCount = (uint32_t)(getPhysicalDeviceExtentions().size());
         info.ppEnabledExtensionNames = getPhysicalDeviceExtentions().data();
-        info.pEnabledFeatures = &features;
+        info.pNext = &features;
 
         device = getPhysicalDevice().createDeviceUnique(info);
         VULKAN_HPP_DEFAULT_DISPATCHER.init(*device);
+
+        allocator = std::make_unique<memory::Allocator>(getPhysicalDevice(), *device);
     }
 
     auto DevicePart::getDevice() -> vk::Device {
@@ -353,7 +465,19 @@ namespace vkr::part {
         return device->getQueue(getPresentQueueFamilyIndex(), 0);
     }
 
-    auto DevicePart::makeBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties) -> std::tuple<vk::UniqueBuffer, vk::UniqueDeviceMemory> {
+    auto DevicePart::getTransferQueue() -> vk::Queue {
+        return device->getQueue(getTransferQueueFamilyIndex(), 0);
+    }
+
+    auto DevicePart::getAllocator() -> memory::Allocator& {
+        return *allocator;
+    }
+
+    auto DevicePart::getDrawIndirectCount() -> bool {
+        return drawIndirectCount;
+    }
+
+    auto DevicePart::makeBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties) -> std::tuple<vk::UniqueBuffer, memory::Allocation> {
         vk::BufferCreateInfo bufferCreateInfo;
         bufferCreateInfo.size = size;
         bufferCreateInfo.usage = usage;
@@ -363,19 +487,26 @@ namespace vkr::part {
 
         vk::MemoryRequirements memoryRequirements = device->getBufferMemoryRequirements(*buffer);
 
-        vk::MemoryAllocateInfo memoryAllocateInfo;
-        memoryAllocateInfo.allocationSize = memoryRequirements.size;
-        memoryAllocateInfo.memoryTypeIndex = getMemoryType(memoryRequirements.memoryTypeBits, properties);
+        memory::Allocation memory = allocator->allocate(*buffer, getMemoryType(memoryRequirements.memoryTypeBits, properties));
 
-        vk::UniqueDeviceMemory memory = device->allocateMemoryUnique(memoryAllocateInfo);
-
-        getDevice().bindBufferMemory(*buffer, *memory, 0);
+        getDevice().bindBufferMemory(*buffer, memory.getMemory(), memory.getOffset());
 
         return { std::move(buffer), std::move(memory) };
     }
 
-    auto DevicePart::makeImage(glm::uvec2 size, uint32_t mipLevels, vk::SampleCountFlagBits sampleCount, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties) -> std::tuple<vk::UniqueImage, vk::UniqueDeviceMemory> {
+    auto DevicePart::reserveBuffer(GrowableBuffer& buffer, vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties) -> bool {
+        if (size <= buffer.capacity) {
+            return false;
+        }
+
+        buffer.capacity = std::max(size, buffer.capacity * 2);
+        std::tie(buffer.buffer, buffer.memory) = makeBuffer(buffer.capacity, usage, properties);
+        return true;
+    }
+
+    auto DevicePart::makeImage(glm::uvec2 size, uint32_t mipLevels, vk::SampleCountFlagBits sampleCount, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, vk::ImageCreateFlags flags) -> std::tuple<vk::UniqueImage, memory::Allocation> {
         vk::ImageCreateInfo imageCreateInfo;
+        imageCreateInfo.flags = flags;
         imageCreateInfo.imageType = vk::ImageType::e2D;
         imageCreateInfo.extent.width = size.x;
         imageCreateInfo.extent.height = size.y;
@@ -392,19 +523,23 @@ namespace vkr::part {
         vk::UniqueImage image = device->createImageUnique(imageCreateInfo);
         vk::MemoryRequirements memoryRequirements = device->getImageMemoryRequirements(*image);
 
-        vk::MemoryAllocateInfo memoryAllocateInfo;
-        memoryAllocateInfo.allocationSize = memoryRequirements.size;
-        memoryAllocateInfo.memoryTypeIndex = getMemoryType(memoryRequirements.memoryTypeBits, properties);
-
-        vk::UniqueDeviceMemory memory = device->allocateMemoryUnique(memoryAllocateInfo);
+        memory::Allocation memory = allocator->allocate(*image, tiling, getMemoryType(memoryRequirements.memoryTypeBits, properties));
 
-        device->bindImageMemory(*image, *memory, 0);
+        device->bindImageMemory(*image, memory.getMemory(), memory.getOffset());
 
         return { std::move(image), std::move(memory) };
     }
 
-    auto DevicePart::makeImageView(vk::Image image, vk::Format format, vk::ImageAspectFlagBits aspectFlags, uint32_t mipLevels) -> vk::UniqueImageView {
+    // A usage narrower than the image's is needed when the image allows usages the view's format doesn't support, like
+    // storage on an sRGB view of a mutable format image.
+    auto DevicePart::makeImageView(vk::Image image, vk::Format format, vk::ImageAspectFlagBits aspectFlags, uint32_t mipLevels, vk::ImageUsageFlags usage) -> vk::UniqueImageView {
+        vk::ImageViewUsageCreateInfo usageCreateInfo;
+        usageCreateInfo.usage = usage;
+
         vk::ImageViewCreateInfo imageViewCreateInfo;
+        if (usage) {
+            imageViewCreateInfo.pNext = &usageCreateInfo;
+        }
         imageViewCreateInfo.image = image;
         imageViewCreateInfo.viewType = vk::ImageViewType::e2D;
         imageViewCreateInfo.format = format;
@@ -430,6 +565,11 @@ namespace vkr::part {
     }
 
     auto SwapchainPart::buildSwapchain(vk::Extent2D extent) -> void {
+        if (getCreateInfo().headless) {
+            format = vk::Format::eR8G8B8A8Srgb;
+            return;
+        }
+
         vk::SwapchainCreateInfoKHR createInfo;
         createInfo.surface = getSurface(); // surface
 
@@ -501,10 +641,28 @@ namespace vkr::part {
         return images.size();
     }
 
+    auto ImagesPart::getSwapchainImage(size_t index) -> vk::Image {
+        return images[index];
+    }
+
     auto ImagesPart::buildImages(vk::Extent2D extent) -> void {
         uniqueImageViews.clear();
 
-        images = getDevice().getSwapchainImagesKHR(getSwapchain());
+        if (getCreateInfo().headless) {
+            images.clear();
+            offscreenImages.clear();
+            offscreenImagesMemory.clear();
+
+            for (size_t i = 0; i < offscreenImageCount; ++i) {
+                auto [image, memory] = makeImage({ extent.width, extent.height }, 1, vk::SampleCountFlagBits::e1, getSwapchainFormat(), vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eDeviceLocal);
+                images.push_back(*image);
+                offscreenImages.push_back(std::move(image));
+                offscreenImagesMemory.push_back(std::move(memory));
+            }
+        }
+        else {
+            images = getDevice().getSwapchainImagesKHR(getSwapchain());
+        }
 
         for (const auto& image : images) {
             uniqueImageViews.push_back(makeImageView(image, getSwapchainFormat(), vk::ImageAspectFlagBits::eColor, 1));
@@ -515,6 +673,8 @@ namespace vkr::part {
         std::vector<vk::AttachmentDescription> descriptions;
         std::stack<vk::AttachmentReference> references;
 
+        vk::ImageLayout presentLayout = getCreateInfo().headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
+
         auto addAttachment = [&](vk::AttachmentDescription description, vk::ImageLayout referenceLayout) {
             descriptions.push_back(description);
             vk::AttachmentReference reference;
@@ -534,7 +694,7 @@ namespace vkr::part {
             description.initialLayout = vk::ImageLayout::eUndefined;
             description.finalLayout = [&]() {
                 if (getMsaaSamples() == vk::SampleCountFlagBits::e1) {
-                    return vk::ImageLayout::ePresentSrcKHR;
+                    return presentLayout;
                 }
                 else {
                     return vk::ImageLayout::eColorAttachmentOptimal;
@@ -573,7 +733,7 @@ namespace vkr::part {
                 description.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
                 description.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
                 description.initialLayout = vk::ImageLayout::eUndefined;
-                description.finalLayout = vk::ImageLayout::ePresentSrcKHR;
+                description.finalLayout = presentLayout;
 
                 addAttachment(description, vk::ImageLayout::eColorAttachmentOptimal);
                 return &references.top();
@@ -587,21 +747,28 @@ namespace vkr::part {
         subpass.pDepthStencilAttachment = &depthReference;
         subpass.pResolveAttachments = colorResolveReference;
 
-        vk::SubpassDependency dependency;
-        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-        dependency.dstSubpass = 0;
-        dependency.srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
-        dependency.srcAccessMask = {};
-        dependency.dstStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
-        dependency.dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+        std::array<vk::SubpassDependency, 2> dependencies;
+        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].dstSubpass = 0;
+        dependencies[0].srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+        dependencies[0].srcAccessMask = {};
+        dependencies[0].dstStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+        dependencies[0].dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+
+        dependencies[1].srcSubpass = 0;
+        dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[1].srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+        dependencies[1].srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+        dependencies[1].dstStageMask = vk::PipelineStageFlagBits::eTransfer;
+        dependencies[1].dstAccessMask = vk::AccessFlagBits::eTransferRead;
 
         vk::RenderPassCreateInfo info;
         info.attachmentCount = static_cast<uint32_t>(descriptions.size());
         info.pAttachments = descriptions.data();
         info.subpassCount = 1;
         info.pSubpasses = &subpass;
-        info.dependencyCount = 1;
-        info.pDependencies = &dependency;
+        info.dependencyCount = getCreateInfo().headless ? 2 : 1;
+        info.pDependencies = dependencies.data();
 
         renderPass = getDevice().createRenderPassUnique(info);
     }
@@ -614,30 +781,62 @@ namespace vkr::part {
         vk::DescriptorSetLayoutBinding uboLayoutBinding;
         uboLayoutBinding.binding = 0;
         uboLayoutBinding.descriptorCount = 1;
-        uboLayoutBinding.descriptorType = vk::DescriptorType::eUniformBuffer;
+        uboLayoutBinding.descriptorType = vk::DescriptorType::eUniformBufferDynamic;
         uboLayoutBinding.pImmutableSamplers = nullptr;
         uboLayoutBinding.stageFlags = vk::ShaderStageFlagBits::eVertex;
 
-        vk::DescriptorSetLayoutBinding samplerLayoutBinding;
-        samplerLayoutBinding.binding = 1;
-        samplerLayoutBinding.descriptorCount = 1;
-        samplerLayoutBinding.descriptorType = vk::DescriptorType::eCombinedImageSampler;
-        samplerLayoutBinding.pImmutableSamplers = nullptr;
-        samplerLayoutBinding.stageFlags = vk::ShaderStageFlagBits::eFragment;
-
-        std::array bindings = { uboLayoutBinding, samplerLayoutBinding };
-
         vk::DescriptorSetLayoutCreateInfo layoutCreateInfo;
-        layoutCreateInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-        layoutCreateInfo.pBindings = bindings.data();
+        layoutCreateInfo.bindingCount = 1;
+        layoutCreateInfo.pBindings = &uboLayoutBinding;
 
         descriptorSetLayout = getDevice().createDescriptorSetLayoutUnique(layoutCreateInfo);
+
+        auto properties = getPhysicalDevice().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>();
+        const vk::PhysicalDeviceVulkan12Properties& properties12 = properties.get<vk::PhysicalDeviceVulkan12Properties>();
+        textureCapacity = std::min({
+            maxTextureCapacity,
+            properties12.maxPerStageDescriptorUpdateAfterBindSamplers,
+            properties12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+            properties12.maxDescriptorSetUpdateAfterBindSamplers,
+            properties12.maxDescriptorSetUpdateAfterBindSampledImages
+        });
+
+        // The texture array is its own set so adding or replacing a texture is a single write, made while frames that
+        // don't use that element are still in flight.
+        vk::DescriptorSetLayoutBinding textureLayoutBinding;
+        textureLayoutBinding.binding = 0;
+        textureLayoutBinding.descriptorCount = textureCapacity;
+        textureLayoutBinding.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+        textureLayoutBinding.pImmutableSamplers = nullptr;
+        textureLayoutBinding.stageFlags = vk::ShaderStageFlagBits::eFragment;
+
+        vk::DescriptorBindingFlags bindingFlags = vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind | vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+
+        vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo;
+        bindingFlagsCreateInfo.bindingCount = 1;
+        bindingFlagsCreateInfo.pBindingFlags = &bindingFlags;
+
+        vk::DescriptorSetLayoutCreateInfo textureLayoutCreateInfo;
+        textureLayoutCreateInfo.flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool;
+        textureLayoutCreateInfo.bindingCount = 1;
+        textureLayoutCreateInfo.pBindings = &textureLayoutBinding;
+        textureLayoutCreateInfo.pNext = &bindingFlagsCreateInfo;
+
+        textureSetLayout = getDevice().createDescriptorSetLayoutUnique(textureLayoutCreateInfo);
     }
 
     auto DescriptorSetLayoutPart::getDescriptorSetLayout() -> vk::DescriptorSetLayout {
         return *descriptorSetLayout;
     }
 
+    auto DescriptorSetLayoutPart::getTextureSetLayout() -> vk::DescriptorSetLayout {
+        return *textureSetLayout;
+    }
+
+    auto DescriptorSetLayoutPart::getTextureCapacity() -> uint32_t {
+        return textureCapacity;
+    }
+
     GraphicsPipelinePart::GraphicsPipelinePart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
         buildGraphicsPipeline(getCurrentExtent());
     }
@@ -651,10 +850,10 @@ namespace vkr::part {
     }
 
     auto GraphicsPipelinePart::buildGraphicsPipeline(vk::Extent2D extent) -> void {
-        vk::DescriptorSetLayout descriptorSetLayout = getDescriptorSetLayout();
+        std::array setLayouts = { getDescriptorSetLayout(), getTextureSetLayout() };
         vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
-        pipelineLayoutInfo.setLayoutCount = 1;
-        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+        pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        pipelineLayoutInfo.pSetLayouts = setLayouts.data();
 
         layout = getDevice().createPipelineLayoutUnique(pipelineLayoutInfo);
 
@@ -678,16 +877,28 @@ namespace vkr::part {
         stageCreateInfos[1].setModule(*fragmentShaderModule);
         stageCreateInfos[1].pName = "main";
 
-        vk::VertexInputBindingDescription vertexBindingDescription;
-        vertexBindingDescription.binding = 0;
-        vertexBindingDescription.stride = sizeof(data::Vertex);
-        vertexBindingDescription.inputRate = vk::VertexInputRate::eVertex;
-
-        std::array vertexAttributeDescriptions = meta::getAttributeDescriptions<data::Vertex>();
+        std::array<vk::VertexInputBindingDescription, 2> vertexBindingDescriptions;
+        vertexBindingDescriptions[0].binding = 0;
+        vertexBindingDescriptions[0].stride = sizeof(data::PackedVertex);
+        vertexBindingDescriptions[0].inputRate = vk::VertexInputRate::eVertex;
+        vertexBindingDescriptions[1].binding = 1;
+        vertexBindingDescriptions[1].stride = sizeof(data::Instance);
+        vertexBindingDescriptions[1].inputRate = vk::VertexInputRate::eInstance;
+
+        std::vector<vk::VertexInputAttributeDescription> vertexAttributeDescriptions;
+        for (vk::VertexInputAttributeDescription description : meta::getAttributeDescriptions<data::PackedVertex>()) {
+            vertexAttributeDescriptions.push_back(description);
+        }
+        auto instanceLocation = static_cast<uint32_t>(vertexAttributeDescriptions.size());
+        for (vk::VertexInputAttributeDescription description : meta::getAttributeDescriptions<data::Instance>()) {
+            description.binding = 1;
+            description.location += instanceLocation;
+            vertexAttributeDescriptions.push_back(description);
+        }
 
         vk::PipelineVertexInputStateCreateInfo vertexInputInfo;
-        vertexInputInfo.vertexBindingDescriptionCount = 1;
-        vertexInputInfo.pVertexBindingDescriptions = &vertexBindingDescription;
+        vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(vertexBindingDescriptions.size());
+        vertexInputInfo.pVertexBindingDescriptions = vertexBindingDescriptions.data();
         vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexAttributeDescriptions.size());
         vertexInputInfo.pVertexAttributeDescriptions = vertexAttributeDescriptions.data();
 
@@ -783,152 +994,399 @@ namespace vkr::part {
         pipeline = getDevice().createGraphicsPipelineUnique({}, pipelineCreateInfo);
     }
 
-    CommandPoolPart::CommandPoolPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
-        vk::CommandPoolCreateInfo info;
-        info.queueFamilyIndex = getGraphicsQueueFamilyIndex();
-        commandPool = getDevice().createCommandPoolUnique(info);
-    }
+    CommandPoolPart::CommandPoolPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {}
 
-    auto CommandPoolPart::getCommandPool() -> vk::CommandPool {
-        return *commandPool;
+    auto CommandPoolPart::copyBuffer(vk::CommandBuffer commandBuffer, vk::Buffer from, vk::Buffer to, vk::DeviceSize size) -> void {
+        vk::BufferCopy copyRegion;
+        copyRegion.size = size;
+        commandBuffer.copyBuffer(from, to, copyRegion);
     }
 
-    auto CommandPoolPart::copyBuffer(vk::Buffer from, vk::Buffer to, vk::DeviceSize size) -> void {
-        executeSingleTimeCommands([&](const vk::CommandBuffer& commandBuffer) {
-            vk::BufferCopy copyRegion;
-            copyRegion.size = size;
-            commandBuffer.copyBuffer(from, to, copyRegion);
-            });
-    }
+    auto CommandPoolPart::transitionImageLayout(vk::CommandBuffer commandBuffer, vk::Image image, vk::Format format, vk::ImageLayout oldLayout, vk::ImageLayout newLayout, uint32_t mipLevels) -> void {
+        vk::ImageMemoryBarrier imageMemoryBarrier;
+        imageMemoryBarrier.oldLayout = oldLayout;
+        imageMemoryBarrier.newLayout = newLayout;
+        imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageMemoryBarrier.image = image;
+        imageMemoryBarrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+        imageMemoryBarrier.subresourceRange.baseMipLevel = 0;
+        imageMemoryBarrier.subresourceRange.levelCount = mipLevels;
+        imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
+        imageMemoryBarrier.subresourceRange.layerCount = 1;
 
-    auto CommandPoolPart::transitionImageLayout(vk::Image image, vk::Format format, vk::ImageLayout oldLayout, vk::ImageLayout newLayout, uint32_t mipLevels) -> void {
-        executeSingleTimeCommands([&](const vk::CommandBuffer& commandBuffer) {
-            vk::ImageMemoryBarrier imageMemoryBarrier;
-            imageMemoryBarrier.oldLayout = oldLayout;
-            imageMemoryBarrier.newLayout = newLayout;
-            imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            imageMemoryBarrier.image = image;
-            imageMemoryBarrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
-            imageMemoryBarrier.subresourceRange.baseMipLevel = 0;
-            imageMemoryBarrier.subresourceRange.levelCount = mipLevels;
-            imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
-            imageMemoryBarrier.subresourceRange.layerCount = 1;
-
-            vk::PipelineStageFlags sourceStage;
-            vk::PipelineStageFlags destinationStage;
-
-            if (oldLayout == vk::ImageLayout::eUndefined && newLayout == vk::ImageLayout::eTransferDstOptimal) {
-                imageMemoryBarrier.srcAccessMask = {};
-                imageMemoryBarrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
-
-                sourceStage = vk::PipelineStageFlagBits::eTopOfPipe;
-                destinationStage = vk::PipelineStageFlagBits::eTransfer;
-            }
-            else if (oldLayout == vk::ImageLayout::eTransferDstOptimal && newLayout == vk::ImageLayout::eShaderReadOnlyOptimal) {
-                imageMemoryBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-                imageMemoryBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+        vk::PipelineStageFlags sourceStage;
+        vk::PipelineStageFlags destinationStage;
 
-                sourceStage = vk::PipelineStageFlagBits::eTransfer;
-                destinationStage = vk::PipelineStageFlagBits::eFragmentShader;
-            }
-            else {
-                throw std::invalid_argument("Unsupported layout transition");
-            }
+        if (oldLayout == vk::ImageLayout::eUndefined && newLayout == vk::ImageLayout::eTransferDstOptimal) {
+            imageMemoryBarrier.srcAccessMask = {};
+            imageMemoryBarrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
 
-            commandBuffer.pipelineBarrier(sourceStage, destinationStage, {}, {}, {}, imageMemoryBarrier);
-            });
+            sourceStage = vk::PipelineStageFlagBits::eTopOfPipe;
+            destinationStage = vk::PipelineStageFlagBits::eTransfer;
+        }
+        else if (oldLayout == vk::ImageLayout::eTransferDstOptimal && newLayout == vk::ImageLayout::eShaderReadOnlyOptimal) {
+            imageMemoryBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+            imageMemoryBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+
+            sourceStage = vk::PipelineStageFlagBits::eTransfer;
+            destinationStage = vk::PipelineStageFlagBits::eFragmentShader;
+        }
+        else {
+            throw std::invalid_argument("Unsupported layout transition");
+        }
+
+        commandBuffer.pipelineBarrier(sourceStage, destinationStage, {}, {}, {}, imageMemoryBarrier);
     }
 
-    auto CommandPoolPart::copyBufferToImage(vk::Buffer buffer, vk::Image image, glm::uvec2 size) -> void {
-        executeSingleTimeCommands([&](const vk::CommandBuffer& commandBuffer) {
-            vk::BufferImageCopy region;
-            region.bufferOffset = 0;
-            region.bufferRowLength = 0;
-            region.bufferImageHeight = 0;
-            region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-            region.imageSubresource.mipLevel = 0;
-            region.imageSubresource.baseArrayLayer = 0;
-            region.imageSubresource.layerCount = 1;
-            region.imageOffset.x = 0;
-            region.imageOffset.y = 0;
-            region.imageOffset.z = 0;
-            region.imageExtent.width = size.x;
-            region.imageExtent.height = size.y;
-            region.imageExtent.depth = 1;
-
-            commandBuffer.copyBufferToImage(buffer, image, vk::ImageLayout::eTransferDstOptimal, region);
-            });
+    auto CommandPoolPart::copyBufferToImage(vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize offset, vk::Image image, glm::uvec2 size, uint32_t mipLevel) -> void {
+        vk::BufferImageCopy region;
+        region.bufferOffset = offset;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+        region.imageSubresource.mipLevel = mipLevel;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset.x = 0;
+        region.imageOffset.y = 0;
+        region.imageOffset.z = 0;
+        region.imageExtent.width = size.x;
+        region.imageExtent.height = size.y;
+        region.imageExtent.depth = 1;
+
+        commandBuffer.copyBufferToImage(buffer, image, vk::ImageLayout::eTransferDstOptimal, region);
     }
 
-    auto CommandPoolPart::generateMipmaps(vk::Image image, vk::Format imageFormat, glm::ivec2 dimentionsBeforeFullscreen, uint32_t mipLevels) -> void {
-        vk::FormatProperties formatProperties = getPhysicalDevice().getFormatProperties(imageFormat);
+    // One barrier per level: each blit reads the level the previous one wrote, and every level is moved to
+    // ShaderReadOnlyOptimal together at the end.
+    auto CommandPoolPart::blitMipmaps(vk::CommandBuffer commandBuffer, vk::Image image, vk::Format format, glm::ivec2 size, uint32_t mipLevels, vk::ImageLayout layout, vk::PipelineStageFlags sourceStage, vk::AccessFlags sourceAccess) -> void {
+        vk::FormatProperties formatProperties = getPhysicalDevice().getFormatProperties(format);
 
         if (!(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear)) {
             throw std::runtime_error("Texture image format does not support linear blitting");
         }
 
-        executeSingleTimeCommands([&](vk::CommandBuffer commandBuffer) {
-            vk::ImageMemoryBarrier barrier;
-            barrier.image = image;
-            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
-            barrier.subresourceRange.baseArrayLayer = 0;
-            barrier.subresourceRange.layerCount = 1;
-            barrier.subresourceRange.levelCount = 1;
-
-            glm::ivec2 mipDimentions = dimentionsBeforeFullscreen;
-
-            for (uint32_t i = 1; i < mipLevels; ++i) {
-                barrier.subresourceRange.baseMipLevel = i - 1;
+        vk::ImageMemoryBarrier barrier;
+        barrier.image = image;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+
+        std::array<vk::ImageMemoryBarrier, 2> barriers = { barrier, barrier };
+        barriers[0].subresourceRange.baseMipLevel = 0;
+        barriers[0].subresourceRange.levelCount = 1;
+        barriers[0].oldLayout = layout;
+        barriers[0].newLayout = vk::ImageLayout::eTransferSrcOptimal;
+        barriers[0].srcAccessMask = sourceAccess;
+        barriers[0].dstAccessMask = vk::AccessFlagBits::eTransferRead;
+        barriers[1].subresourceRange.baseMipLevel = 1;
+        barriers[1].subresourceRange.levelCount = mipLevels - 1;
+        barriers[1].oldLayout = vk::ImageLayout::eUndefined;
+        barriers[1].newLayout = vk::ImageLayout::eTransferDstOptimal;
+        barriers[1].srcAccessMask = {};
+        barriers[1].dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+
+        commandBuffer.pipelineBarrier(sourceStage, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, vk::ArrayProxy<const vk::ImageMemoryBarrier>(mipLevels > 1 ? 2 : 1, barriers.data()));
+
+        glm::ivec2 mipDimentions = size;
+
+        for (uint32_t i = 1; i < mipLevels; ++i) {
+            glm::ivec2 nextDimentions = glm::max(mipDimentions / 2, glm::ivec2(1));
+
+            vk::ImageBlit blit;
+            blit.srcOffsets[0].setX(0).setY(0).setZ(0);
+            blit.srcOffsets[1].setX(mipDimentions.x).setY(mipDimentions.y).setZ(1);
+            blit.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+            blit.srcSubresource.mipLevel = i - 1;
+            blit.srcSubresource.baseArrayLayer = 0;
+            blit.srcSubresource.layerCount = 1;
+            blit.dstOffsets[0].setX(0).setY(0).setZ(0);
+            blit.dstOffsets[1].setX(nextDimentions.x).setY(nextDimentions.y).setZ(1);
+            blit.dstSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+            blit.dstSubresource.mipLevel = i;
+            blit.dstSubresource.baseArrayLayer = 0;
+            blit.dstSubresource.layerCount = 1;
+
+            commandBuffer.blitImage(image, vk::ImageLayout::eTransferSrcOptimal, image, vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eLinear);
+
+            if (i + 1 < mipLevels) {
+                barrier.subresourceRange.baseMipLevel = i;
+                barrier.subresourceRange.levelCount = 1;
                 barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
                 barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
                 barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
                 barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
 
                 commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, barrier);
+            }
 
-                vk::ImageBlit blit;
-                blit.srcOffsets[0].setX(0).setY(0).setZ(0);
-                blit.srcOffsets[1].setX(mipDimentions.x).setY(mipDimentions.y).setZ(1);
-                blit.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-                blit.srcSubresource.mipLevel = i - 1;
-                blit.srcSubresource.baseArrayLayer = 0;
-                blit.srcSubresource.layerCount = 1;
-                blit.dstOffsets[0].setX(0).setY(0).setZ(0);
-                blit.dstOffsets[1].setX(mipDimentions.x > 1 ? mipDimentions.x / 2 : 1).setY(mipDimentions.y > 1 ? mipDimentions.y / 2 : 1).setZ(1);
-                blit.dstSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-                blit.dstSubresource.mipLevel = i;
-                blit.dstSubresource.baseArrayLayer = 0;
-                blit.dstSubresource.layerCount = 1;
-
-                commandBuffer.blitImage(image, vk::ImageLayout::eTransferSrcOptimal, image, vk::ImageLayout::eTransferDstOptimal, vk::ImageBlit(blit), vk::Filter::eLinear);
-
-                barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
-                barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-                barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
-                barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-
-                commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, barrier);
-
-                if (mipDimentions.x > 1) {
-                    mipDimentions.x /= 2;
-                }
+            mipDimentions = nextDimentions;
+        }
 
-                if (mipDimentions.y > 1) {
-                    mipDimentions.y /= 2;
-                }
+        barriers[0].subresourceRange.baseMipLevel = 0;
+        barriers[0].subresourceRange.levelCount = std::max(mipLevels - 1, 1u);
+        barriers[0].oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+        barriers[0].newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        barriers[0].srcAccessMask = vk::AccessFlagBits::eTransferRead;
+        barriers[0].dstAccessMask = vk::AccessFlagBits::eShaderRead;
+        barriers[1].subresourceRange.baseMipLevel = mipLevels - 1;
+        barriers[1].subresourceRange.levelCount = 1;
+        barriers[1].oldLayout = vk::ImageLayout::eTransferDstOptimal;
+        barriers[1].newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        barriers[1].srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barriers[1].dstAccessMask = vk::AccessFlagBits::eShaderRead;
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, vk::ArrayProxy<const vk::ImageMemoryBarrier>(mipLevels > 1 ? 2 : 1, barriers.data()));
+    }
+
+    UploadPart::UploadPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
+        dedicatedTransfer = getTransferQueueFamilyIndex() != getGraphicsQueueFamilyIndex();
+
+        vk::CommandPoolCreateInfo info;
+        info.flags = vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+        info.queueFamilyIndex = getGraphicsQueueFamilyIndex();
+        uploadCommandPool = getDevice().createCommandPoolUnique(info);
+
+        if (dedicatedTransfer) {
+            info.queueFamilyIndex = getTransferQueueFamilyIndex();
+            transferCommandPool = getDevice().createCommandPoolUnique(info);
+        }
+    }
+
+    auto UploadPart::getTransferCommandBuffer() -> vk::CommandBuffer {
+        beginBatch();
+        if (!dedicatedTransfer) {
+            return *recording->commandBuffer;
+        }
+        recording->transferRecorded = true;
+        return *recording->transferCommandBuffer;
+    }
+
+    auto UploadPart::getUploadCommandBuffer() -> vk::CommandBuffer {
+        beginBatch();
+        return *recording->commandBuffer;
+    }
+
+    auto UploadPart::getDedicatedTransfer() -> bool {
+        return dedicatedTransfer;
+    }
+
+    auto UploadPart::beginBatch() -> void {
+        if (recording) {
+            return;
+        }
+
+        if (!freeBatches.empty()) {
+            recording = std::move(freeBatches.back());
+            freeBatches.pop_back();
+        }
+        else {
+            vk::CommandBufferAllocateInfo allocateInfo;
+            allocateInfo.commandPool = *uploadCommandPool;
+            allocateInfo.level = vk::CommandBufferLevel::ePrimary;
+            allocateInfo.commandBufferCount = 1;
+
+            recording.emplace();
+            recording->commandBuffer = std::move(getDevice().allocateCommandBuffersUnique(allocateInfo)[0]);
+            recording->fence = getDevice().createFenceUnique({});
+
+            if (dedicatedTransfer) {
+                allocateInfo.commandPool = *transferCommandPool;
+                recording->transferCommandBuffer = std::move(getDevice().allocateCommandBuffersUnique(allocateInfo)[0]);
+                recording->semaphore = getDevice().createSemaphoreUnique({});
             }
+        }
 
-            barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-            barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-            barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-            barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-            barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+        vk::CommandBufferBeginInfo beginInfo;
+        beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+        recording->commandBuffer->begin(beginInfo);
+
+        // Frames still in flight may have written vertices into a buffer this batch copies when it grows.
+        vk::MemoryBarrier barrier;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite;
+        recording->commandBuffer->pipelineBarrier(vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, barrier, {}, {});
+        if (dedicatedTransfer) {
+            recording->transferCommandBuffer->begin(beginInfo);
+        }
+    }
 
-            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, barrier);
-            });
+    auto UploadPart::makeStagingBuffer(vk::DeviceSize size) -> std::tuple<vk::Buffer, void*> {
+        beginBatch();
+
+        auto [buffer, memory] = makeBuffer(size, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        std::tuple<vk::Buffer, void*> result = { *buffer, memory.getMapped() };
+
+        retire(std::move(buffer));
+        retire(std::move(memory));
+
+        return result;
+    }
+
+    auto UploadPart::releaseBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize size, vk::AccessFlags dstAccess) -> void {
+        if (!dedicatedTransfer) {
+            return;
+        }
+
+        vk::BufferMemoryBarrier barrier;
+        barrier.srcQueueFamilyIndex = getTransferQueueFamilyIndex();
+        barrier.dstQueueFamilyIndex = getGraphicsQueueFamilyIndex();
+        barrier.buffer = buffer;
+        barrier.offset = offset;
+        barrier.size = size;
+
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        getTransferCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, barrier, {});
+
+        barrier.srcAccessMask = {};
+        barrier.dstAccessMask = dstAccess;
+        getUploadCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eComputeShader, {}, {}, barrier, {});
+    }
+
+    auto UploadPart::releaseImage(vk::Image image, vk::ImageLayout layout, uint32_t mipLevels, vk::AccessFlags dstAccess) -> void {
+        if (!dedicatedTransfer) {
+            return;
+        }
+
+        vk::ImageMemoryBarrier barrier;
+        barrier.srcQueueFamilyIndex = getTransferQueueFamilyIndex();
+        barrier.dstQueueFamilyIndex = getGraphicsQueueFamilyIndex();
+        barrier.image = image;
+        barrier.oldLayout = layout;
+        barrier.newLayout = layout;
+        barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = mipLevels;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        getTransferCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, {}, barrier);
+
+        barrier.srcAccessMask = {};
+        barrier.dstAccessMask = dstAccess;
+        getUploadCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, barrier);
+    }
+
+    auto UploadPart::flushUploads() -> void {
+        if (!recording) {
+            return;
+        }
+
+        vk::MemoryBarrier barrier;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead | vk::AccessFlagBits::eUniformRead | vk::AccessFlagBits::eShaderRead;
+
+        recording->commandBuffer->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader, {}, barrier, {}, {});
+        recording->commandBuffer->end();
+
+        vk::SubmitInfo submitInfo;
+        std::array waitStages = { vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader) };
+
+        if (dedicatedTransfer) {
+            recording->transferCommandBuffer->end();
+        }
+
+        if (recording->transferRecorded) {
+            vk::SubmitInfo transferSubmitInfo;
+            transferSubmitInfo.commandBufferCount = 1;
+            transferSubmitInfo.pCommandBuffers = &*recording->transferCommandBuffer;
+            transferSubmitInfo.signalSemaphoreCount = 1;
+            transferSubmitInfo.pSignalSemaphores = &*recording->semaphore;
+
+            getTransferQueue().submit(transferSubmitInfo, {});
+
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores = &*recording->semaphore;
+            submitInfo.pWaitDstStageMask = waitStages.data();
+        }
+
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &*recording->commandBuffer;
+
+        getGraphicsQueue().submit(submitInfo, *recording->fence);
+
+        batchesInFlight.push_back(std::move(*recording));
+        recording.reset();
+    }
+
+    auto UploadPart::collectUploads() -> void {
+        while (!batchesInFlight.empty() && getDevice().getFenceStatus(*batchesInFlight.front().fence) == vk::Result::eSuccess) {
+            UploadBatch batch = std::move(batchesInFlight.front());
+            batchesInFlight.pop_front();
+
+            getDevice().resetFences(*batch.fence);
+            batch.commandBuffer->reset();
+            if (batch.transferCommandBuffer) {
+                batch.transferCommandBuffer->reset();
+            }
+            batch.resources.clear();
+            batch.transferRecorded = false;
+            freeBatches.push_back(std::move(batch));
+        }
+    }
+
+    FrameDataPart::FrameDataPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
+        const vk::PhysicalDeviceLimits& limits = getPhysicalDevice().getProperties().limits;
+        alignment = std::max({ limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment, static_cast<vk::DeviceSize>(16) });
+        buildFrameData(getCreateInfo().frameDataSize);
+    }
+
+    auto FrameDataPart::buildFrameData(vk::DeviceSize size) -> void {
+        frameSize = (size + alignment - 1) / alignment * alignment;
+
+        vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferSrc;
+        std::tie(buffer, memory) = makeBuffer(frameSize * maxFramesInFlight, usage, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        version++;
+    }
+
+    auto FrameDataPart::getMaxFramesInFlight() -> uint32_t {
+        return maxFramesInFlight;
+    }
+
+    auto FrameDataPart::getFrameDataBuffer() -> vk::Buffer {
+        return *buffer;
+    }
+
+    // Changes whenever the ring is replaced, so descriptors pointing at it have to be written again.
+    auto FrameDataPart::getFrameDataVersion() -> uint64_t {
+        return version;
+    }
+
+    auto FrameDataPart::beginFrameData(size_t frame) -> void {
+        frameIndex = frame;
+        head = frame * frameSize;
+        end = head + frameSize;
+    }
+
+    // A frame that outgrows its region moves to a ring with at least twice the space. What it already allocated stays
+    // in the old buffer, which is kept alive with deferDestruction until the frames reading it have completed.
+    auto FrameDataPart::allocateFrameData(vk::DeviceSize size) -> std::tuple<vk::DeviceSize, void*> {
+        if (head + size > end) {
+            deferDestruction(std::move(buffer));
+            deferDestruction(std::move(memory));
+            buildFrameData(std::max(frameSize * 2, size));
+            spdlog::info("Frame data grew to {} bytes per frame", frameSize);
+            beginFrameData(frameIndex);
+        }
+
+        vk::DeviceSize offset = head;
+        head = (offset + size + alignment - 1) / alignment * alignment;
+        return { offset, static_cast<uint8_t*>(memory.getMapped()) + offset };
+    }
+
+    auto FrameDataPart::markFrameSubmitted(uint64_t frameNumber) -> void {
+        submittedFrameNumber = frameNumber;
+    }
+
+    // Frames finish in submission order on the graphics queue, so every frame up to completedFrameNumber is done.
+    auto FrameDataPart::collectDeferred(uint64_t completedFrameNumber) -> void {
+        while (!deferredResources.empty() && deferredResources.front().frameNumber <= completedFrameNumber) {
+            deferredResources.pop_front();
+        }
     }
 
     ColorResourcesPart::ColorResourcesPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
@@ -976,8 +1434,8 @@ namespace vkr::part {
         buildFramebuffers(getCurrentExtent());
     }
 
-    auto FramebufferPart::getFramebuffers() -> std::vector<vk::Framebuffer> {
-        return vk::uniqueToRaw(framebuffers);
+    auto FramebufferPart::getFramebuffer(size_t index) -> vk::Framebuffer {
+        return *framebuffers[index];
     }
 
     auto FramebufferPart::buildFramebuffers(vk::Extent2D extent) -> void {
@@ -1005,142 +1463,1070 @@ namespace vkr::part {
         }
     }
 
-    TexturePart::TexturePart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
-        setTexture(data::Texture());
-    }
+    MipmapPart::MipmapPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
+        if (getCreateInfo().mipGenerator != api::MipGenerator::eCompute) {
+            return;
+        }
 
-    auto TexturePart::getTextureImageView() -> const vk::ImageView& {
-        return *textureImageView;
-    }
+        // The level 0 sampler, a storage image for each level mipmap.comp writes and its workgroup counter.
+        std::array<vk::DescriptorSetLayoutBinding, maxComputeLevels + 1> bindings;
+        for (size_t i = 0; i < bindings.size(); ++i) {
+            bindings[i].binding = static_cast<uint32_t>(i);
+            bindings[i].descriptorCount = 1;
+            bindings[i].descriptorType = vk::DescriptorType::eStorageImage;
+            bindings[i].stageFlags = vk::ShaderStageFlagBits::eCompute;
+        }
+        bindings.front().descriptorType = vk::DescriptorType::eCombinedImageSampler;
+        bindings.back().descriptorType = vk::DescriptorType::eStorageBuffer;
 
-    auto TexturePart::getTextureSampler() -> const vk::Sampler& {
-        return *sampler;
-    }
+        vk::DescriptorSetLayoutCreateInfo layoutCreateInfo;
+        layoutCreateInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutCreateInfo.pBindings = bindings.data();
 
-    auto TexturePart::setTexture(const data::Texture& texture) -> void {
-        mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texture.getDimentions().x, texture.getDimentions().y)))) + 1;
+        mipmapDescriptorSetLayout = getDevice().createDescriptorSetLayoutUnique(layoutCreateInfo);
 
-        vk::DeviceSize imageSize = texture.getSize();
+        vk::PushConstantRange pushConstantRange;
+        pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eCompute;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(data::Mipmap);
+
+        vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &*mipmapDescriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-        auto [stagingBuffer, stagingBufferMemory] = makeBuffer(imageSize, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        mipmapLayout = getDevice().createPipelineLayoutUnique(pipelineLayoutInfo);
 
-        void* data = getDevice().mapMemory(*stagingBufferMemory, 0, imageSize);
-        memcpy(data, texture.getPixels(), static_cast<size_t>(imageSize));
-        getDevice().unmapMemory(*stagingBufferMemory);
+        std::vector<uint32_t> code = io::file::read<uint32_t>("shaders/mipmap.comp.spv");
 
-        std::tie(image, memory) = makeImage(texture.getDimentions(), mipLevels, vk::SampleCountFlagBits::e1, vk::Format::eR8G8B8A8Srgb, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, vk::MemoryPropertyFlagBits::eDeviceLocal);
+        vk::ShaderModuleCreateInfo shaderModuleInfo;
+        shaderModuleInfo.codeSize = code.size() * sizeof(uint32_t);
+        shaderModuleInfo.pCode = code.data();
 
-        transitionImageLayout(*image, vk::Format::eR8G8B8A8Srgb, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, mipLevels);
-        copyBufferToImage(*stagingBuffer, *image, texture.getDimentions());
+        vk::UniqueShaderModule shaderModule = getDevice().createShaderModuleUnique(shaderModuleInfo);
 
-        generateMipmaps(*image, vk::Format::eR8G8B8A8Srgb, texture.getDimentions(), mipLevels);
+        vk::ComputePipelineCreateInfo pipelineCreateInfo;
+        pipelineCreateInfo.stage.stage = vk::ShaderStageFlagBits::eCompute;
+        pipelineCreateInfo.stage.setModule(*shaderModule);
+        pipelineCreateInfo.stage.pName = "main";
+        pipelineCreateInfo.layout = *mipmapLayout;
 
-        textureImageView = makeImageView(*image, vk::Format::eR8G8B8A8Srgb, vk::ImageAspectFlagBits::eColor, mipLevels);
+        mipmapPipeline = getDevice().createComputePipelineUnique({}, pipelineCreateInfo);
 
         vk::SamplerCreateInfo samplerCreateInfo;
-        samplerCreateInfo.magFilter = vk::Filter::eLinear;
-        samplerCreateInfo.minFilter = vk::Filter::eLinear;
-        samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
-        samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
-        samplerCreateInfo.addressModeW = vk::SamplerAddressMode::eRepeat;
-        samplerCreateInfo.anisotropyEnable = true;
-        samplerCreateInfo.maxAnisotropy = 16.0f;
-        samplerCreateInfo.borderColor = vk::BorderColor::eFloatOpaqueBlack;
-        samplerCreateInfo.unnormalizedCoordinates = false;
-        samplerCreateInfo.compareEnable = false;
-        samplerCreateInfo.compareOp = vk::CompareOp::eAlways;
-        samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
-        samplerCreateInfo.minLod = 0.0f;
-        samplerCreateInfo.maxLod = static_cast<float>(mipLevels);
-        samplerCreateInfo.mipLodBias = 0.0f;
+        samplerCreateInfo.magFilter = vk::Filter::eNearest;
+        samplerCreateInfo.minFilter = vk::Filter::eNearest;
+        samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+        samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+        samplerCreateInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;
+        samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
 
-        sampler = getDevice().createSamplerUnique(samplerCreateInfo);
+        mipmapSampler = getDevice().createSamplerUnique(samplerCreateInfo);
+
+        std::tie(mipmapCounter, mipmapCounterMemory) = makeBuffer(sizeof(uint32_t), vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eDeviceLocal);
+        getUploadCommandBuffer().fillBuffer(*mipmapCounter, 0, sizeof(uint32_t), 0);
     }
 
-    ModelDataPart::ModelDataPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {}
+    auto MipmapPart::getMipmapImageUsage() -> vk::ImageUsageFlags {
+        vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled;
+        if (mipmapPipeline) {
+            usage |= vk::ImageUsageFlagBits::eStorage;
+        }
+        return usage;
+    }
 
-    ModelDataPart::~ModelDataPart() {
-        getDevice().unmapMemory(*vertexStagingBufferMemory);
+    // sRGB formats can't be storage images, so mipmap.comp writes those through UNORM views of a mutable format image.
+    auto MipmapPart::getMipmapImageFlags(vk::Format format) -> vk::ImageCreateFlags {
+        if (!mipmapPipeline || format == vk::Format::eR8G8B8A8Unorm) {
+            return {};
+        }
+        return vk::ImageCreateFlagBits::eMutableFormat | vk::ImageCreateFlagBits::eExtendedUsage;
     }
 
-    auto ModelDataPart::pushModel(const data::Model& data) -> void {
-        {
-            std::copy(vertexSpan.begin(), vertexSpan.end(), model.vertices.begin());
-            model.indices.reserve(model.indices.size() + data.indices.size());
-            for (uint32_t index : data.indices) {
-                model.indices.push_back(index + static_cast<uint32_t>(model.vertices.size()));
-            }
-            model.vertices.insert(model.vertices.end(), data.vertices.begin(), data.vertices.end());
+    auto MipmapPart::makeMipmapImage(vk::Image image, vk::Format format, glm::ivec2 size, uint32_t mipLevels) -> MipmapImage {
+        if (format != vk::Format::eR8G8B8A8Srgb && format != vk::Format::eR8G8B8A8Unorm) {
+            throw std::runtime_error(fmt::format("Mipmaps can't be generated for {} images", vk::to_string(format)));
         }
-        {
-            vk::DeviceSize bufferSize = model.vertices.size() * sizeof(model.vertices[0]);
 
-            std::tie(vertexStagingBuffer, vertexStagingBufferMemory) = makeBuffer(bufferSize, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        MipmapImage target;
+        target.image = image;
+        target.format = format;
+        target.size = size;
+        target.mipLevels = mipLevels;
 
-            void* data = getDevice().mapMemory(*vertexStagingBufferMemory, 0, bufferSize);
-            memcpy(data, model.vertices.data(), static_cast<size_t>(bufferSize));
-            vertexSpan = std::span<data::Vertex>(static_cast<data::Vertex*>(data), model.vertices.size());
+        if (!getComputeSupported(target)) {
+            return target;
+        }
 
-            std::tie(vertexBuffer, vertexBufferMemory) = makeBuffer(bufferSize, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+        auto makeLevelView = [&](vk::Format viewFormat, uint32_t level, vk::ImageUsageFlags usage) {
+            vk::ImageViewUsageCreateInfo usageCreateInfo;
+            usageCreateInfo.usage = usage;
+
+            vk::ImageViewCreateInfo imageViewCreateInfo;
+            imageViewCreateInfo.pNext = &usageCreateInfo;
+            imageViewCreateInfo.image = image;
+            imageViewCreateInfo.viewType = vk::ImageViewType::e2D;
+            imageViewCreateInfo.format = viewFormat;
+            imageViewCreateInfo.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+            imageViewCreateInfo.subresourceRange.baseMipLevel = level;
+            imageViewCreateInfo.subresourceRange.levelCount = 1;
+            imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+            imageViewCreateInfo.subresourceRange.layerCount = 1;
+
+            return getDevice().createImageViewUnique(imageViewCreateInfo);
+        };
 
-            copyBuffer(*vertexStagingBuffer, *vertexBuffer, vertexSpan.size_bytes());
+        target.views.push_back(makeLevelView(format, 0, vk::ImageUsageFlagBits::eSampled));
+        for (uint32_t level = 1; level < mipLevels; ++level) {
+            target.views.push_back(makeLevelView(vk::Format::eR8G8B8A8Unorm, level, vk::ImageUsageFlagBits::eStorage));
         }
-        {
-            vk::DeviceSize bufferSize = model.indices.size() * sizeof(model.indices[0]);
-            auto [stagingBuffer, stagingBufferMemory] = makeBuffer(bufferSize, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
 
-            void* data = getDevice().mapMemory(*stagingBufferMemory, 0, bufferSize);
-            memcpy(data, model.indices.data(), static_cast<size_t>(bufferSize));
-            getDevice().unmapMemory(*stagingBufferMemory);
+        std::array<vk::DescriptorPoolSize, 3> poolSizes;
+        poolSizes[0].type = vk::DescriptorType::eCombinedImageSampler;
+        poolSizes[0].descriptorCount = 1;
+        poolSizes[1].type = vk::DescriptorType::eStorageImage;
+        poolSizes[1].descriptorCount = maxComputeLevels - 1;
+        poolSizes[2].type = vk::DescriptorType::eStorageBuffer;
+        poolSizes[2].descriptorCount = 1;
+
+        vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo;
+        descriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        descriptorPoolCreateInfo.pPoolSizes = poolSizes.data();
+        descriptorPoolCreateInfo.maxSets = 1;
 
-            std::tie(indexBuffer, indexBufferMemory) = makeBuffer(bufferSize, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+        target.descriptorPool = getDevice().createDescriptorPoolUnique(descriptorPoolCreateInfo);
 
-            copyBuffer(*stagingBuffer, *indexBuffer, bufferSize);
+        vk::DescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.descriptorPool = *target.descriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = 1;
+        descriptorSetAllocateInfo.pSetLayouts = &*mipmapDescriptorSetLayout;
+
+        target.descriptorSet = getDevice().allocateDescriptorSets(descriptorSetAllocateInfo)[0];
+
+        // Bindings past the last level are never written by the shader but still need a valid view.
+        std::array<vk::DescriptorImageInfo, maxComputeLevels> imageInfos;
+        std::array<vk::WriteDescriptorSet, maxComputeLevels + 1> descriptorWrites;
+        for (uint32_t i = 0; i < maxComputeLevels; ++i) {
+            imageInfos[i].imageView = *target.views[std::min(i, mipLevels - 1)];
+            imageInfos[i].imageLayout = vk::ImageLayout::eGeneral;
+
+            descriptorWrites[i].dstSet = target.descriptorSet;
+            descriptorWrites[i].dstBinding = i;
+            descriptorWrites[i].dstArrayElement = 0;
+            descriptorWrites[i].descriptorType = vk::DescriptorType::eStorageImage;
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pImageInfo = &imageInfos[i];
         }
-    }
+        imageInfos[0].sampler = *mipmapSampler;
+        imageInfos[0].imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        descriptorWrites[0].descriptorType = vk::DescriptorType::eCombinedImageSampler;
 
-    auto ModelDataPart::getVertexBuffer() -> const vk::Buffer& {
-        return *vertexBuffer;
+        vk::DescriptorBufferInfo bufferInfo;
+        bufferInfo.buffer = *mipmapCounter;
+        bufferInfo.offset = 0;
+        bufferInfo.range = VK_WHOLE_SIZE;
+
+        descriptorWrites.back().dstSet = target.descriptorSet;
+        descriptorWrites.back().dstBinding = maxComputeLevels;
+        descriptorWrites.back().dstArrayElement = 0;
+        descriptorWrites.back().descriptorType = vk::DescriptorType::eStorageBuffer;
+        descriptorWrites.back().descriptorCount = 1;
+        descriptorWrites.back().pBufferInfo = &bufferInfo;
+
+        getDevice().updateDescriptorSets(descriptorWrites, {});
+
+        return target;
+    }
+
+    // mipmap.comp reduces level 0 in 64x64 tiles down to level 6, which then has to fit in a single tile.
+    auto MipmapPart::getComputeSupported(const MipmapImage& target) -> bool {
+        return mipmapPipeline && target.mipLevels > 1 && target.size.x <= 4096 && target.size.y <= 4096;
+    }
+
+    // Every level of target is expected in layout, with level 0 holding the content, and ends up ShaderReadOnlyOptimal.
+    auto MipmapPart::generateMipmaps(vk::CommandBuffer commandBuffer, const MipmapImage& target, vk::ImageLayout layout) -> void {
+        vk::PipelineStageFlags sourceStage;
+        vk::AccessFlags sourceAccess;
+
+        if (layout == vk::ImageLayout::eTransferDstOptimal) {
+            sourceStage = vk::PipelineStageFlagBits::eTransfer;
+            sourceAccess = vk::AccessFlagBits::eTransferWrite;
+        }
+        else if (layout == vk::ImageLayout::eShaderReadOnlyOptimal) {
+            sourceStage = vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader;
+            sourceAccess = {};
+        }
+        else {
+            throw std::invalid_argument("Unsupported layout for mipmap generation");
+        }
+
+        if (getComputeSupported(target)) {
+            dispatchMipmaps(commandBuffer, target, layout, sourceStage, sourceAccess);
+        }
+        else {
+            blitMipmaps(commandBuffer, target.image, target.format, target.size, target.mipLevels, layout, sourceStage, sourceAccess);
+        }
+    }
+
+    // A single dispatch for the whole chain: one barrier into it and one out of it.
+    auto MipmapPart::dispatchMipmaps(vk::CommandBuffer commandBuffer, const MipmapImage& target, vk::ImageLayout layout, vk::PipelineStageFlags sourceStage, vk::AccessFlags sourceAccess) -> void {
+        vk::ImageMemoryBarrier barrier;
+        barrier.image = target.image;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+
+        std::array<vk::ImageMemoryBarrier, 2> barriers = { barrier, barrier };
+        barriers[0].subresourceRange.baseMipLevel = 0;
+        barriers[0].subresourceRange.levelCount = 1;
+        barriers[0].oldLayout = layout;
+        barriers[0].newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        barriers[0].srcAccessMask = sourceAccess;
+        barriers[0].dstAccessMask = vk::AccessFlagBits::eShaderRead;
+        barriers[1].subresourceRange.baseMipLevel = 1;
+        barriers[1].subresourceRange.levelCount = target.mipLevels - 1;
+        barriers[1].oldLayout = vk::ImageLayout::eUndefined;
+        barriers[1].newLayout = vk::ImageLayout::eGeneral;
+        barriers[1].srcAccessMask = {};
+        barriers[1].dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+
+        // Orders the counter after its initial fill and after the previous dispatch, which leaves it at zero.
+        vk::MemoryBarrier counterBarrier;
+        counterBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eShaderWrite;
+        counterBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+
+        commandBuffer.pipelineBarrier(sourceStage | vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, counterBarrier, {}, barriers);
+
+        glm::uvec2 workgroups = (glm::uvec2(target.size) + 63u) / 64u;
+
+        data::Mipmap mipmap;
+        mipmap.size = target.size;
+        mipmap.mipLevels = target.mipLevels;
+        mipmap.workgroupCount = workgroups.x * workgroups.y;
+        mipmap.srgb = target.format == vk::Format::eR8G8B8A8Srgb ? 1 : 0;
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *mipmapPipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *mipmapLayout, 0, target.descriptorSet, {});
+        commandBuffer.pushConstants(*mipmapLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(data::Mipmap), &mipmap);
+        commandBuffer.dispatch(workgroups.x, workgroups.y, 1);
+
+        barrier.subresourceRange.baseMipLevel = 1;
+        barrier.subresourceRange.levelCount = target.mipLevels - 1;
+        barrier.oldLayout = vk::ImageLayout::eGeneral;
+        barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        barrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, barrier);
+    }
+
+    TexturePart::TexturePart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
+        vk::SamplerCreateInfo samplerCreateInfo;
+        samplerCreateInfo.magFilter = vk::Filter::eLinear;
+        samplerCreateInfo.minFilter = vk::Filter::eLinear;
+        samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
+        samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
+        samplerCreateInfo.addressModeW = vk::SamplerAddressMode::eRepeat;
+        samplerCreateInfo.anisotropyEnable = true;
+        samplerCreateInfo.maxAnisotropy = 16.0f;
+        samplerCreateInfo.borderColor = vk::BorderColor::eFloatOpaqueBlack;
+        samplerCreateInfo.unnormalizedCoordinates = false;
+        samplerCreateInfo.compareEnable = false;
+        samplerCreateInfo.compareOp = vk::CompareOp::eAlways;
+        samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+        samplerCreateInfo.minLod = 0.0f;
+        samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+        samplerCreateInfo.mipLodBias = 0.0f;
+
+        sampler = getDevice().createSamplerUnique(samplerCreateInfo);
+
+        vk::DescriptorPoolSize poolSize;
+        poolSize.type = vk::DescriptorType::eCombinedImageSampler;
+        poolSize.descriptorCount = getTextureCapacity();
+
+        vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo;
+        descriptorPoolCreateInfo.flags = vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind;
+        descriptorPoolCreateInfo.poolSizeCount = 1;
+        descriptorPoolCreateInfo.pPoolSizes = &poolSize;
+        descriptorPoolCreateInfo.maxSets = 1;
+
+        textureDescriptorPool = getDevice().createDescriptorPoolUnique(descriptorPoolCreateInfo);
+
+        vk::DescriptorSetLayout setLayout = getTextureSetLayout();
+
+        vk::DescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.descriptorPool = *textureDescriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = 1;
+        descriptorSetAllocateInfo.pSetLayouts = &setLayout;
+
+        textureSet = getDevice().allocateDescriptorSets(descriptorSetAllocateInfo)[0];
+
+        pushTexture(data::Texture());
+    }
+
+    auto TexturePart::getTextureSet() -> vk::DescriptorSet {
+        return textureSet;
+    }
+
+    auto TexturePart::getTextureCount() -> uint32_t {
+        return static_cast<uint32_t>(textures.size());
+    }
+
+    auto TexturePart::getTextureDescriptor(uint32_t texture) -> uint32_t {
+        return textures[texture].descriptor;
+    }
+
+    auto TexturePart::pushTexture(const data::Texture& texture, bool dynamic) -> uint32_t {
+        TextureSlot slot;
+        uploadTexture(slot, texture, dynamic);
+        textures.push_back(std::move(slot));
+        return static_cast<uint32_t>(textures.size() - 1);
+    }
+
+    // The replacement is written to a free descriptor, as frames in flight may still sample the old one. The old image
+    // and its descriptor are parked with deferDestruction until every frame that might sample them has completed.
+    auto TexturePart::setTexture(uint32_t texture, const data::Texture& data, bool dynamic) -> void {
+        if (texture >= textures.size()) {
+            throw std::runtime_error(fmt::format("Texture {} does not exist", texture));
+        }
+
+        TextureSlot slot;
+        uploadTexture(slot, data, dynamic);
+        std::swap(textures[texture], slot);
+
+        deferDestruction(std::shared_ptr<void>(nullptr, [freeDescriptors = std::weak_ptr(freeDescriptors), descriptor = slot.descriptor](void*) {
+            if (std::shared_ptr<std::vector<uint32_t>> list = freeDescriptors.lock()) {
+                list->push_back(descriptor);
+            }
+        }));
+        deferDestruction(std::move(slot));
+    }
+
+    // Every level of a static texture is built before upload, by the texture cache, the transcoder or here on the CPU
+    // for textures that come with a single level, so uploading is a copy per level. Formats the device can't sample are
+    // decompressed to RGBA8 first. A dynamic texture only uploads level 0 and builds the others on the GPU, again every
+    // time it is marked dirty.
+    auto TexturePart::uploadTexture(TextureSlot& slot, const data::Texture& texture, bool dynamic) -> void {
+        vk::Format format = texture.getFormat();
+        vk::FormatFeatureFlags features = getPhysicalDevice().getFormatProperties(format).optimalTilingFeatures;
+        if (!(features & vk::FormatFeatureFlagBits::eSampledImage) || !(features & vk::FormatFeatureFlagBits::eSampledImageFilterLinear)) {
+            if (bc::getBlockSize(format) == 0) {
+                throw std::runtime_error(fmt::format("The device can't sample {} textures and they can't be decompressed on the CPU", vk::to_string(format)));
+            }
+            spdlog::warn("The device can't sample {} textures, decompressing to RGBA8", vk::to_string(format));
+            uploadTexture(slot, texture.decompress(), dynamic);
+            return;
+        }
+
+        if (dynamic && bc::getBlockSize(format) != 0) {
+            uploadTexture(slot, texture.decompress(), dynamic);
+            return;
+        }
+
+        if (!dynamic && texture.getLevels().size() == 1 && bc::getBlockSize(format) == 0 && mip::getLevelCount(texture.getDimentions()) > 1) {
+            uploadTexture(slot, mip::buildMipChain(texture), dynamic);
+            return;
+        }
+
+        std::span<const data::TextureLevel> levels = texture.getLevels();
+        uint32_t mipLevels = dynamic ? mip::getLevelCount(texture.getDimentions()) : static_cast<uint32_t>(levels.size());
+
+        vk::DeviceSize imageSize = texture.getSize();
+
+        auto [stagingBuffer, stagingData] = makeStagingBuffer(imageSize);
+
+        memcpy(stagingData, texture.getPixels(), static_cast<size_t>(imageSize));
+
+        vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled;
+        vk::ImageCreateFlags flags;
+        if (dynamic) {
+            usage |= getMipmapImageUsage();
+            flags = getMipmapImageFlags(format);
+        }
+
+        std::tie(slot.image, slot.memory) = makeImage(texture.getDimentions(), mipLevels, vk::SampleCountFlagBits::e1, format, vk::ImageTiling::eOptimal, usage, vk::MemoryPropertyFlagBits::eDeviceLocal, flags);
+
+        auto uploadedLevels = dynamic ? 1u : mipLevels;
+        transitionImageLayout(getTransferCommandBuffer(), *slot.image, format, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, mipLevels);
+        for (uint32_t level = 0; level < uploadedLevels; ++level) {
+            copyBufferToImage(getTransferCommandBuffer(), stagingBuffer, levels[level].offset, *slot.image, texture.getLevelDimentions(level), level);
+        }
+        releaseImage(*slot.image, vk::ImageLayout::eTransferDstOptimal, mipLevels, vk::AccessFlagBits::eTransferWrite);
+
+        if (dynamic) {
+            slot.mipmapImage = makeMipmapImage(*slot.image, format, texture.getDimentions(), mipLevels);
+            generateMipmaps(getUploadCommandBuffer(), *slot.mipmapImage, vk::ImageLayout::eTransferDstOptimal);
+            slot.view = makeImageView(*slot.image, format, vk::ImageAspectFlagBits::eColor, mipLevels, vk::ImageUsageFlagBits::eSampled);
+        }
+        else {
+            transitionImageLayout(getUploadCommandBuffer(), *slot.image, format, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, mipLevels);
+            slot.view = makeImageView(*slot.image, format, vk::ImageAspectFlagBits::eColor, mipLevels);
+        }
+
+        slot.descriptor = allocateDescriptor();
+
+        vk::DescriptorImageInfo imageInfo;
+        imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        imageInfo.imageView = *slot.view;
+        imageInfo.sampler = *sampler;
+
+        vk::WriteDescriptorSet descriptorWrite;
+        descriptorWrite.dstSet = textureSet;
+        descriptorWrite.dstBinding = 0;
+        descriptorWrite.dstArrayElement = slot.descriptor;
+        descriptorWrite.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pImageInfo = &imageInfo;
+
+        getDevice().updateDescriptorSets(descriptorWrite, {});
+    }
+
+    auto TexturePart::allocateDescriptor() -> uint32_t {
+        if (!freeDescriptors->empty()) {
+            uint32_t descriptor = freeDescriptors->back();
+            freeDescriptors->pop_back();
+            return descriptor;
+        }
+
+        if (descriptorCount == getTextureCapacity()) {
+            throw std::runtime_error(fmt::format("The texture table is full, the device allows {} textures", getTextureCapacity()));
+        }
+
+        return descriptorCount++;
+    }
+
+    // Level 0 of a dynamic texture was rewritten on the GPU; its other levels are rebuilt in the next frame.
+    auto TexturePart::markTextureDirty(uint32_t texture) -> void {
+        if (texture >= textures.size()) {
+            throw std::runtime_error(fmt::format("Texture {} does not exist", texture));
+        }
+
+        textures[texture].dirty = textures[texture].mipmapImage.has_value();
+    }
+
+    auto TexturePart::recordTextureMipmaps(vk::CommandBuffer commandBuffer) -> void {
+        for (TextureSlot& slot : textures) {
+            if (slot.dirty) {
+                generateMipmaps(commandBuffer, *slot.mipmapImage, vk::ImageLayout::eShaderReadOnlyOptimal);
+                slot.dirty = false;
+            }
+        }
+    }
+
+    ModelDataPart::ModelDataPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {}
+
+    // The CPU side lives in data::appendModel; this uploads what it appended.
+    auto ModelDataPart::pushModel(const data::Model& data) -> uint32_t {
+        vk::IndexType previousIndexType = store.indexType;
+        uint32_t first = data::appendModel(store, data);
+        const data::Mesh& mesh = store.meshes[first];
+        bool widen = store.indexType != previousIndexType;
+
+        vk::DeviceSize indexStride = store.indexType == vk::IndexType::eUint16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        vk::DeviceSize vertexOffset = static_cast<vk::DeviceSize>(mesh.vertexOffset) * sizeof(data::PackedVertex);
+        vk::DeviceSize indexOffset = widen ? 0 : mesh.firstIndex * indexStride;
+        vk::DeviceSize vertexSize = store.model.vertices.size() * sizeof(data::PackedVertex);
+        vk::DeviceSize indexSize = store.model.indices.size() * indexStride;
+
+        vk::CommandBuffer commandBuffer = getTransferCommandBuffer();
+
+        if (vertexSize > vertexCapacity) {
+            vk::DeviceSize capacity = std::max(vertexSize, vertexCapacity * 2);
+            growBuffer(vertexBuffer, vertexBufferMemory, vertexOffset, capacity, vk::BufferUsageFlagBits::eVertexBuffer);
+            vertexCapacity = capacity;
+        }
+
+        if (widen || indexSize > indexCapacity) {
+            vk::DeviceSize capacity = std::max(indexSize, indexCapacity * 2);
+            growBuffer(indexBuffer, indexBufferMemory, indexOffset, capacity, vk::BufferUsageFlagBits::eIndexBuffer);
+            indexCapacity = capacity;
+        }
+
+        if (vertexSize > vertexOffset) {
+            auto [stagingBuffer, stagingData] = makeStagingBuffer(vertexSize - vertexOffset);
+            data::packVertices(store, static_cast<size_t>(mesh.vertexOffset), store.model.vertices.size(), static_cast<data::PackedVertex*>(stagingData));
+
+            vk::BufferCopy region;
+            region.srcOffset = 0;
+            region.dstOffset = vertexOffset;
+            region.size = vertexSize - vertexOffset;
+            commandBuffer.copyBuffer(stagingBuffer, *vertexBuffer, region);
+
+            releaseBuffer(*vertexBuffer, region.dstOffset, region.size, vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite);
+        }
+
+        if (indexSize > indexOffset) {
+            auto [stagingBuffer, stagingData] = makeStagingBuffer(indexSize - indexOffset);
+            data::packIndices(store, static_cast<size_t>(indexOffset / indexStride), store.model.indices.size(), stagingData);
+
+            vk::BufferCopy region;
+            region.srcOffset = 0;
+            region.dstOffset = indexOffset;
+            region.size = indexSize - indexOffset;
+            commandBuffer.copyBuffer(stagingBuffer, *indexBuffer, region);
+
+            releaseBuffer(*indexBuffer, region.dstOffset, region.size, vk::AccessFlagBits::eIndexRead | vk::AccessFlagBits::eTransferRead);
+        }
+
+        vk::DeviceSize meshletOffset = mesh.firstMeshlet * sizeof(data::Meshlet);
+        vk::DeviceSize meshletSize = store.meshlets.size() * sizeof(data::Meshlet);
+
+        if (meshletSize > meshletCapacity) {
+            vk::DeviceSize capacity = std::max(meshletSize, meshletCapacity * 2);
+            growBuffer(meshletBuffer, meshletBufferMemory, meshletOffset, capacity, vk::BufferUsageFlagBits::eStorageBuffer);
+            meshletCapacity = capacity;
+        }
+
+        if (meshletSize > meshletOffset) {
+            auto [stagingBuffer, stagingData] = makeStagingBuffer(meshletSize - meshletOffset);
+            memcpy(stagingData, store.meshlets.data() + mesh.firstMeshlet, static_cast<size_t>(meshletSize - meshletOffset));
+
+            vk::BufferCopy region;
+            region.srcOffset = 0;
+            region.dstOffset = meshletOffset;
+            region.size = meshletSize - meshletOffset;
+            commandBuffer.copyBuffer(stagingBuffer, *meshletBuffer, region);
+
+            releaseBuffer(*meshletBuffer, region.dstOffset, region.size, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eTransferRead);
+        }
+
+        return first;
+    }
+
+    auto ModelDataPart::growBuffer(vk::UniqueBuffer& buffer, memory::Allocation& memory, vk::DeviceSize used, vk::DeviceSize capacity, vk::BufferUsageFlags usage) -> void {
+        auto [grownBuffer, grownMemory] = makeBuffer(capacity, vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst | usage, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+        if (used > 0) {
+            copyBuffer(getUploadCommandBuffer(), *buffer, *grownBuffer, used);
+        }
+
+        deferDestruction(std::move(buffer));
+        deferDestruction(std::move(memory));
+        buffer = std::move(grownBuffer);
+        memory = std::move(grownMemory);
+    }
+
+    auto ModelDataPart::getVertexBuffer() -> const vk::Buffer& {
+        return *vertexBuffer;
     }
 
     auto ModelDataPart::getIndexCount() -> size_t {
-        return model.indices.size();
+        return store.model.indices.size();
     }
 
     auto ModelDataPart::getIndexBuffer() -> const vk::Buffer& {
         return *indexBuffer;
     }
 
-    auto ModelDataPart::getVertexSpan() -> std::span<data::Vertex> {
-        return std::span<data::Vertex>(model.vertices);
+    auto ModelDataPart::getMeshletBuffer() -> vk::Buffer {
+        return *meshletBuffer;
+    }
+
+    auto ModelDataPart::getIndexType() -> vk::IndexType {
+        return store.indexType;
+    }
+
+    auto ModelDataPart::getMesh(uint32_t mesh) -> const data::Mesh& {
+        return store.meshes.at(mesh);
+    }
+
+    auto ModelDataPart::getMeshCount() -> size_t {
+        return store.meshes.size();
+    }
+
+    auto ModelDataPart::getVertexSpan() -> std::span<const data::Vertex> {
+        return std::span<const data::Vertex>(store.model.vertices);
+    }
+
+    auto ModelDataPart::getVertexSpan(size_t offset, size_t count) -> std::span<data::Vertex> {
+        markDirty(offset, count);
+        return std::span<data::Vertex>(store.model.vertices).subspan(offset, count);
+    }
+
+    auto ModelDataPart::markDirty(size_t offset, size_t count) -> void {
+        offset = std::min(offset, store.model.vertices.size());
+        count = std::min(count, store.model.vertices.size() - offset);
+        if (count > 0) {
+            dirtyRanges.emplace_back(offset, offset + count);
+        }
+    }
+
+    // Dirty vertices are packed straight into the frame data ring and copied from there.
+    auto ModelDataPart::recordVertexUpdates(vk::CommandBuffer commandBuffer) -> void {
+        if (dirtyRanges.empty()) {
+            return;
+        }
+
+        algorithm::coalesce(dirtyRanges);
+
+        vk::DeviceSize size = 0;
+        for (auto [begin, end] : dirtyRanges) {
+            size += (end - begin) * sizeof(data::PackedVertex);
+        }
+
+        auto [stagingOffset, staging] = allocateFrameData(size);
+
+        dirtyRegions.clear();
+        vk::DeviceSize offset = 0;
+        for (auto [begin, end] : dirtyRanges) {
+            vk::BufferCopy region;
+            region.srcOffset = stagingOffset + offset;
+            region.dstOffset = begin * sizeof(data::PackedVertex);
+            region.size = (end - begin) * sizeof(data::PackedVertex);
+            data::packVertices(store, begin, end, reinterpret_cast<data::PackedVertex*>(static_cast<uint8_t*>(staging) + offset));
+            dirtyRegions.push_back(region);
+            offset += region.size;
+        }
+        dirtyRanges.clear();
+
+        vk::MemoryBarrier barrier;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, barrier, {}, {});
+
+        commandBuffer.copyBuffer(getFrameDataBuffer(), *vertexBuffer, dirtyRegions);
+
+        vk::BufferMemoryBarrier bufferBarrier;
+        bufferBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        bufferBarrier.dstAccessMask = vk::AccessFlagBits::eVertexAttributeRead;
+        bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.buffer = *vertexBuffer;
+        bufferBarrier.offset = 0;
+        bufferBarrier.size = VK_WHOLE_SIZE;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eVertexInput, {}, {}, bufferBarrier, {});
+    }
+
+    InstancesPart::InstancesPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {}
+
+    auto InstancesPart::addInstance(uint32_t mesh, const glm::mat4& transform, uint32_t texture) -> uint32_t {
+        if (mesh >= getMeshCount()) {
+            throw std::runtime_error(fmt::format("Mesh {} does not exist", mesh));
+        }
+
+        if (texture >= getTextureCount()) {
+            throw std::runtime_error(fmt::format("Texture {} does not exist", texture));
+        }
+
+        if (mesh >= meshInstances.size()) {
+            meshInstances.resize(getMeshCount());
+            meshInstanceHandles.resize(getMeshCount());
+        }
+
+        uint32_t instance = 0;
+        if (!freeSlots.empty()) {
+            instance = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            instance = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+
+        slots[instance].mesh = mesh;
+        slots[instance].index = static_cast<uint32_t>(meshInstances[mesh].size());
+
+        data::Instance& data = meshInstances[mesh].emplace_back();
+        data.setTransform(transform);
+        data.material.x = texture;
+        meshInstanceHandles[mesh].push_back(instance);
+
+        instanceCount++;
+        version++;
+        return instance;
+    }
+
+    auto InstancesPart::setInstanceTransform(uint32_t instance, const glm::mat4& transform) -> void {
+        Slot& slot = getSlot(instance);
+        meshInstances[slot.mesh][slot.index].setTransform(transform);
+        version++;
     }
 
-    auto ModelDataPart::updateStagingBuffer() -> void {
-        std::copy(model.vertices.begin(), model.vertices.end(), vertexSpan.begin());
-        copyBuffer(*vertexStagingBuffer, *vertexBuffer, vertexSpan.size_bytes());
+    auto InstancesPart::setInstanceTexture(uint32_t instance, uint32_t texture) -> void {
+        if (texture >= getTextureCount()) {
+            throw std::runtime_error(fmt::format("Texture {} does not exist", texture));
+        }
+
+        Slot& slot = getSlot(instance);
+        meshInstances[slot.mesh][slot.index].material.x = texture;
+        version++;
     }
 
-    UniformBuffersPart::UniformBuffersPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
-        buildUniformBuffers();
+    auto InstancesPart::removeInstance(uint32_t instance) -> void {
+        Slot& slot = getSlot(instance);
+        detachInstance(slot);
+
+        slot = Slot();
+        freeSlots.push_back(instance);
+
+        instanceCount--;
+        version++;
     }
 
-    auto UniformBuffersPart::buildUniformBuffers() -> void {
-        uniformBuffers.clear();
-        uniformBuffersMemory.clear();
+    auto InstancesPart::detachInstance(const Slot& slot) -> void {
+        std::vector<data::Instance>& instances = meshInstances[slot.mesh];
+        std::vector<uint32_t>& handles = meshInstanceHandles[slot.mesh];
+
+        uint32_t index = slot.index;
+        instances[index] = instances.back();
+        handles[index] = handles.back();
+        slots[handles[index]].index = index;
+        instances.pop_back();
+        handles.pop_back();
+    }
 
-        for (size_t i = 0; i < getSwapchainImageCount(); ++i) {
-            auto [buffer, memory] = makeBuffer(sizeof(data::UBO), vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-            uniformBuffers.push_back(std::move(buffer));
-            uniformBuffersMemory.push_back(std::move(memory));
+    auto InstancesPart::moveInstance(uint32_t instance, uint32_t mesh) -> void {
+        Slot& slot = slots[instance];
+        data::Instance data = meshInstances[slot.mesh][slot.index];
+        detachInstance(slot);
+
+        if (mesh >= meshInstances.size()) {
+            meshInstances.resize(getMeshCount());
+            meshInstanceHandles.resize(getMeshCount());
         }
+
+        slot.mesh = mesh;
+        slot.index = static_cast<uint32_t>(meshInstances[mesh].size());
+        meshInstances[mesh].push_back(data);
+        meshInstanceHandles[mesh].push_back(instance);
+        version++;
     }
 
-    auto UniformBuffersPart::getUniformBuffers() -> std::vector<vk::Buffer> {
-        return vk::uniqueToRaw(uniformBuffers);
+    auto InstancesPart::getSlot(uint32_t instance) -> Slot& {
+        if (instance >= slots.size() || slots[instance].mesh == std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error(fmt::format("Instance {} does not exist", instance));
+        }
+        return slots[instance];
     }
 
-    auto UniformBuffersPart::getUniformBuffersMemory() -> std::vector<vk::DeviceMemory> {
-        return vk::uniqueToRaw(uniformBuffersMemory);
+    auto InstancesPart::getInstanceCount() -> uint32_t {
+        return static_cast<uint32_t>(instanceCount);
+    }
+
+    // Instance data is written to the frame data ring every frame, after LOD selection has moved instances between
+    // meshes, so nothing has to track which frames still hold stale copies.
+    auto InstancesPart::prepareInstances() -> void {
+        if (instanceCount == 0) {
+            return;
+        }
+
+        auto allocate = [&](vk::DeviceSize size, vk::DescriptorBufferInfo& info) {
+            auto [offset, mapped] = allocateFrameData(size);
+            info = vk::DescriptorBufferInfo(getFrameDataBuffer(), offset, size);
+            return mapped;
+        };
+
+        auto instances = static_cast<data::Instance*>(allocate(instanceCount * sizeof(data::Instance), instanceData));
+        auto objects = static_cast<uint32_t*>(allocate(instanceCount * sizeof(uint32_t), objectData));
+        auto meshes = static_cast<data::Mesh*>(allocate(getMeshCount() * sizeof(data::Mesh), meshData));
+
+        // Vertex positions are quantized per mesh, so the dequantization is folded into each instance's transform and
+        // the culling bounds become the unit sphere the quantized positions live in. Texture coordinates are quantized
+        // per mesh too and travel with the instance. Textures are resolved to the descriptor currently holding them.
+        for (size_t i = 0; i < meshInstances.size(); ++i) {
+            glm::mat4 dequantization = getMesh(static_cast<uint32_t>(i)).getDequantization();
+            glm::vec4 textureDequantization = getMesh(static_cast<uint32_t>(i)).getTextureDequantization();
+            for (const data::Instance& instance : meshInstances[i]) {
+                instances->setTransform(instance.getTransform() * dequantization);
+                instances->material = glm::u32vec4(getTextureDescriptor(instance.material.x), 0, 0, 0);
+                instances->textureTransform = textureDequantization;
+                instances++;
+            }
+            objects = std::fill_n(objects, meshInstances[i].size(), static_cast<uint32_t>(i));
+        }
+
+        for (size_t i = 0; i < getMeshCount(); ++i) {
+            meshes[i] = getMesh(static_cast<uint32_t>(i));
+            meshes[i].bounds = glm::vec4(0.0f, 0.0f, 0.0f, meshes[i].bounds.w > 0.0f ? 1.0f : 0.0f);
+        }
+    }
+
+    // The projected error of a level is its simplification error scaled into pixels at the instance's distance. An
+    // instance takes the coarsest level under the threshold, but only coarsens once that level is under the threshold
+    // shrunk by the hysteresis, so objects sitting at a switching distance don't pop back and forth.
+    auto InstancesPart::selectLods(const glm::vec3& camera, float projectionScale) -> void {
+        float threshold = getCreateInfo().lodErrorThreshold;
+        float coarsenThreshold = threshold * (1.0f - getCreateInfo().lodHysteresis);
+
+        for (uint32_t instance = 0; instance < slots.size(); ++instance) {
+            Slot& slot = slots[instance];
+            if (slot.mesh == std::numeric_limits<uint32_t>::max()) {
+                continue;
+            }
+
+            uint32_t base = slot.mesh - slot.lod;
+            const data::Mesh& mesh = getMesh(base);
+            if (mesh.lodCount <= 1) {
+                continue;
+            }
+
+            glm::mat4 transform = meshInstances[slot.mesh][slot.index].getTransform();
+            glm::vec3 center = glm::vec3(transform * glm::vec4(glm::vec3(mesh.bounds), 1.0f));
+            float scale = std::max(glm::length(glm::vec3(transform[0])), std::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+            float distance = glm::distance(center, camera) - mesh.bounds.w * scale;
+
+            auto getProjectedError = [&](uint32_t lod) {
+                return distance > 0.0f ? getMesh(base + lod).lodError * scale / distance * projectionScale : std::numeric_limits<float>::infinity();
+            };
+
+            uint32_t lod = 0;
+            while (lod + 1 < mesh.lodCount && getProjectedError(lod + 1) < threshold) {
+                lod++;
+            }
+
+            if (lod > slot.lod) {
+                lod = slot.lod;
+                while (lod + 1 < mesh.lodCount && getProjectedError(lod + 1) < coarsenThreshold) {
+                    lod++;
+                }
+            }
+
+            if (lod != slot.lod) {
+                moveInstance(instance, base + lod);
+                slot.lod = lod;
+            }
+        }
+    }
+
+    auto InstancesPart::getInstanceData() -> const vk::DescriptorBufferInfo& {
+        return instanceData;
+    }
+
+    auto InstancesPart::getObjectData() -> const vk::DescriptorBufferInfo& {
+        return objectData;
+    }
+
+    auto InstancesPart::getMeshData() -> const vk::DescriptorBufferInfo& {
+        return meshData;
+    }
+
+    auto InstancesPart::getDraws() -> std::span<const Draw> {
+        if (drawsVersion != version) {
+            drawList.clear();
+            uint32_t firstInstance = 0;
+            for (size_t i = 0; i < meshInstances.size(); ++i) {
+                auto count = static_cast<uint32_t>(meshInstances[i].size());
+                if (count > 0) {
+                    Draw draw;
+                    draw.mesh = static_cast<uint32_t>(i);
+                    draw.instanceCount = count;
+                    draw.firstInstance = firstInstance;
+                    drawList.push_back(draw);
+                }
+                firstInstance += count;
+            }
+            drawsVersion = version;
+        }
+        return drawList;
+    }
+
+    auto InstancesPart::getTriangleCount() -> size_t {
+        size_t count = 0;
+        for (const Draw& draw : getDraws()) {
+            count += static_cast<size_t>(getMesh(draw.mesh).indexCount / 3) * draw.instanceCount;
+        }
+        return count;
+    }
+
+    auto InstancesPart::recordDraws(vk::CommandBuffer commandBuffer, std::span<const Draw> draws) -> void {
+        if (draws.empty() || getVertexBuffer() == VK_NULL_HANDLE || getIndexBuffer() == VK_NULL_HANDLE) {
+            return;
+        }
+
+        std::array buffers = { getVertexBuffer(), getInstanceData().buffer };
+        std::array<vk::DeviceSize, 2> offsets = { 0, getInstanceData().offset };
+        commandBuffer.bindVertexBuffers(0, buffers, offsets);
+        commandBuffer.bindIndexBuffer(getIndexBuffer(), 0, getIndexType());
+
+        for (const Draw& draw : draws) {
+            const data::Mesh& mesh = getMesh(draw.mesh);
+            commandBuffer.drawIndexed(mesh.indexCount, draw.instanceCount, mesh.firstIndex, mesh.vertexOffset, draw.firstInstance);
+        }
+    }
+
+    CullingPart::CullingPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
+        if (getCreateInfo().drawPath != api::DrawPath::eGpuCulling) {
+            return;
+        }
+
+        if (!getDrawIndirectCount()) {
+            spdlog::warn("drawIndirectCount is not supported, culling is disabled");
+            return;
+        }
+
+        std::array<vk::DescriptorSetLayoutBinding, bindingCount> bindings;
+        for (size_t i = 0; i < bindings.size(); ++i) {
+            bindings[i].binding = static_cast<uint32_t>(i);
+            bindings[i].descriptorCount = 1;
+            bindings[i].descriptorType = vk::DescriptorType::eStorageBuffer;
+            bindings[i].stageFlags = vk::ShaderStageFlagBits::eCompute;
+        }
+
+        vk::DescriptorSetLayoutCreateInfo layoutCreateInfo;
+        layoutCreateInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutCreateInfo.pBindings = bindings.data();
+
+        descriptorSetLayout = getDevice().createDescriptorSetLayoutUnique(layoutCreateInfo);
+
+        vk::PushConstantRange pushConstantRange;
+        pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eCompute;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(data::Culling);
+
+        vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &*descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        layout = getDevice().createPipelineLayoutUnique(pipelineLayoutInfo);
+
+        pipeline = buildCullingPipeline("shaders/cull.comp.spv");
+        clusterPipeline = buildCullingPipeline("shaders/cluster.comp.spv");
+    }
+
+    auto CullingPart::buildCullingPipeline(const char* file) -> vk::UniquePipeline {
+        std::vector<uint32_t> code = io::file::read<uint32_t>(file);
+
+        vk::ShaderModuleCreateInfo shaderModuleInfo;
+        shaderModuleInfo.codeSize = code.size() * sizeof(uint32_t);
+        shaderModuleInfo.pCode = code.data();
+
+        vk::UniqueShaderModule shaderModule = getDevice().createShaderModuleUnique(shaderModuleInfo);
+
+        vk::ComputePipelineCreateInfo pipelineCreateInfo;
+        pipelineCreateInfo.stage.stage = vk::ShaderStageFlagBits::eCompute;
+        pipelineCreateInfo.stage.setModule(*shaderModule);
+        pipelineCreateInfo.stage.pName = "main";
+        pipelineCreateInfo.layout = *layout;
+
+        return getDevice().createComputePipelineUnique({}, pipelineCreateInfo);
+    }
+
+    // Two passes: cull.comp tests whole instances and compacts the survivors into an indirect dispatch, then
+    // cluster.comp runs one workgroup per surviving instance and emits a draw for every meshlet that passes the
+    // frustum and normal cone tests.
+    auto CullingPart::recordCulling(vk::CommandBuffer commandBuffer, size_t frame, const glm::mat4& viewProjection, const glm::vec3& camera) -> void {
+        if (!pipeline || getInstanceCount() == 0 || !getMeshletBuffer()) {
+            return;
+        }
+
+        if (frame >= frameCulling.size()) {
+            frameCulling.resize(frame + 1);
+        }
+
+        FrameCulling& current = frameCulling[frame];
+
+        current.maxDrawCount = 0;
+        for (const Draw& draw : getDraws()) {
+            current.maxDrawCount += draw.instanceCount * getMesh(draw.mesh).meshletCount;
+        }
+
+        vk::BufferUsageFlags indirectUsage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst;
+        reserveBuffer(current.commands, std::max(current.maxDrawCount, 1u) * sizeof(vk::DrawIndexedIndirectCommand), indirectUsage, vk::MemoryPropertyFlagBits::eDeviceLocal);
+        reserveBuffer(current.count, sizeof(uint32_t), indirectUsage, vk::MemoryPropertyFlagBits::eDeviceLocal);
+        reserveBuffer(current.visible, getInstanceCount() * sizeof(uint32_t), vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+        reserveBuffer(current.dispatch, sizeof(vk::DispatchIndirectCommand), indirectUsage, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+        if (!current.descriptorPool) {
+            vk::DescriptorPoolSize poolSize;
+            poolSize.type = vk::DescriptorType::eStorageBuffer;
+            poolSize.descriptorCount = static_cast<uint32_t>(current.bound.size());
+
+            vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo;
+            descriptorPoolCreateInfo.poolSizeCount = 1;
+            descriptorPoolCreateInfo.pPoolSizes = &poolSize;
+            descriptorPoolCreateInfo.maxSets = 1;
+
+            current.descriptorPool = getDevice().createDescriptorPoolUnique(descriptorPoolCreateInfo);
+
+            vk::DescriptorSetAllocateInfo descriptorSetAllocateInfo;
+            descriptorSetAllocateInfo.descriptorPool = *current.descriptorPool;
+            descriptorSetAllocateInfo.descriptorSetCount = 1;
+            descriptorSetAllocateInfo.pSetLayouts = &*descriptorSetLayout;
+
+            current.descriptorSet = getDevice().allocateDescriptorSets(descriptorSetAllocateInfo)[0];
+        }
+
+        // Instance data moves around the frame data ring, so the set is rewritten whenever a range changes.
+        auto whole = [](vk::Buffer buffer) {
+            return vk::DescriptorBufferInfo(buffer, 0, VK_WHOLE_SIZE);
+        };
+        std::array<vk::DescriptorBufferInfo, bindingCount> buffers = {
+            getInstanceData(), getObjectData(), getMeshData(), whole(*current.commands.buffer),
+            whole(*current.count.buffer), whole(getMeshletBuffer()), whole(*current.visible.buffer), whole(*current.dispatch.buffer)
+        };
+        if (buffers != current.bound) {
+            std::array<vk::WriteDescriptorSet, bindingCount> descriptorWrites;
+            for (size_t i = 0; i < buffers.size(); ++i) {
+                descriptorWrites[i].dstSet = current.descriptorSet;
+                descriptorWrites[i].dstBinding = static_cast<uint32_t>(i);
+                descriptorWrites[i].dstArrayElement = 0;
+                descriptorWrites[i].descriptorType = vk::DescriptorType::eStorageBuffer;
+                descriptorWrites[i].descriptorCount = 1;
+                descriptorWrites[i].pBufferInfo = &buffers[i];
+            }
+            getDevice().updateDescriptorSets(descriptorWrites, {});
+            current.bound = buffers;
+        }
+
+        commandBuffer.fillBuffer(*current.count.buffer, 0, sizeof(uint32_t), 0);
+        vk::DispatchIndirectCommand dispatch(0, 1, 1);
+        commandBuffer.updateBuffer(*current.dispatch.buffer, 0, sizeof(dispatch), &dispatch);
+
+        vk::MemoryBarrier clearBarrier;
+        clearBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        clearBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {}, clearBarrier, {}, {});
+
+        data::Culling culling;
+        culling.planes = math::getFrustumPlanes(viewProjection);
+        culling.camera = glm::vec4(camera, 1.0f);
+        culling.instanceCount = getInstanceCount();
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *layout, 0, current.descriptorSet, {});
+        commandBuffer.pushConstants(*layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(data::Culling), &culling);
+        commandBuffer.dispatch((culling.instanceCount + 63) / 64, 1, 1);
+
+        vk::MemoryBarrier instanceBarrier;
+        instanceBarrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+        instanceBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eIndirectCommandRead;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eDrawIndirect, {}, instanceBarrier, {}, {});
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *clusterPipeline);
+        commandBuffer.dispatchIndirect(*current.dispatch.buffer, 0);
+
+        vk::MemoryBarrier cullBarrier;
+        cullBarrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+        cullBarrier.dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect, {}, cullBarrier, {}, {});
+    }
+
+    auto CullingPart::recordIndirectDraws(vk::CommandBuffer commandBuffer, size_t frame) -> void {
+        if (!pipeline) {
+            recordDraws(commandBuffer, getDraws());
+            return;
+        }
+
+        if (getInstanceCount() == 0 || getVertexBuffer() == VK_NULL_HANDLE || getIndexBuffer() == VK_NULL_HANDLE || !getMeshletBuffer()) {
+            return;
+        }
+
+        std::array buffers = { getVertexBuffer(), getInstanceData().buffer };
+        std::array<vk::DeviceSize, 2> offsets = { 0, getInstanceData().offset };
+        commandBuffer.bindVertexBuffers(0, buffers, offsets);
+        commandBuffer.bindIndexBuffer(getIndexBuffer(), 0, getIndexType());
+
+        FrameCulling& current = frameCulling[frame];
+        commandBuffer.drawIndexedIndirectCount(*current.commands.buffer, 0, *current.count.buffer, 0, current.maxDrawCount, sizeof(vk::DrawIndexedIndirectCommand));
+    }
+
+    auto CullingPart::getCullingEnabled() -> bool {
+        return static_cast<bool>(pipeline);
     }
 
     DescriptorPoolPart::DescriptorPoolPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
@@ -1152,15 +2538,13 @@ namespace vkr::part {
     }
 
     auto DescriptorPoolPart::buildDescriptorPool() -> void {
-        std::array<vk::DescriptorPoolSize, 2> descriptorPoolSizes;
-        descriptorPoolSizes[0].type = vk::DescriptorType::eUniformBuffer;
-        descriptorPoolSizes[0].descriptorCount = static_cast<uint32_t>(getSwapchainImageCount());
-        descriptorPoolSizes[1].type = vk::DescriptorType::eCombinedImageSampler;
-        descriptorPoolSizes[1].descriptorCount = static_cast<uint32_t>(getSwapchainImageCount());
+        vk::DescriptorPoolSize descriptorPoolSize;
+        descriptorPoolSize.type = vk::DescriptorType::eUniformBufferDynamic;
+        descriptorPoolSize.descriptorCount = static_cast<uint32_t>(getSwapchainImageCount());
 
         vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo;
-        descriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(descriptorPoolSizes.size());
-        descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes.data();
+        descriptorPoolCreateInfo.poolSizeCount = 1;
+        descriptorPoolCreateInfo.pPoolSizes = &descriptorPoolSize;
         descriptorPoolCreateInfo.maxSets = static_cast<uint32_t>(getSwapchainImageCount());
         descriptorPoolCreateInfo.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet;
 
@@ -1180,47 +2564,85 @@ namespace vkr::part {
         descriptorSetAllocateInfo.pSetLayouts = layouts.data();
 
         descriptorSets = getDevice().allocateDescriptorSets(descriptorSetAllocateInfo);
+        frameDataVersions.assign(descriptorSets.size(), 0);
+    }
 
-        std::vector<vk::Buffer> uniformBuffers = getUniformBuffers();
+    auto DescriptorSetsPart::getDescriptorSets() -> const std::vector<vk::DescriptorSet>& {
+        return descriptorSets;
+    }
 
-        for (size_t i = 0; i < getSwapchainImageCount(); ++i) {
-            vk::DescriptorBufferInfo descriptorBufferInfo;
-            descriptorBufferInfo.buffer = uniformBuffers[i];
-            descriptorBufferInfo.offset = 0;
-            descriptorBufferInfo.range = sizeof(data::UBO);
+    // The camera UBO lives in the frame data ring, which is replaced when it grows, so a set is pointed at the current
+    // buffer right before its image is recorded. Frames using the set have completed by then.
+    auto DescriptorSetsPart::updateDescriptorSet(size_t imageIndex) -> void {
+        if (frameDataVersions[imageIndex] == getFrameDataVersion()) {
+            return;
+        }
 
-            vk::DescriptorImageInfo imageInfo;
-            imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-            imageInfo.imageView = getTextureImageView();
-            imageInfo.sampler = getTextureSampler();
+        vk::DescriptorBufferInfo descriptorBufferInfo;
+        descriptorBufferInfo.buffer = getFrameDataBuffer();
+        descriptorBufferInfo.offset = 0;
+        descriptorBufferInfo.range = sizeof(data::UBO);
 
-            std::array<vk::WriteDescriptorSet, 2> descriptorWrites;
+        vk::WriteDescriptorSet descriptorWrite;
+        descriptorWrite.dstSet = descriptorSets[imageIndex];
+        descriptorWrite.dstBinding = 0;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType = vk::DescriptorType::eUniformBufferDynamic;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pBufferInfo = &descriptorBufferInfo;
 
-            descriptorWrites[0].dstSet = descriptorSets[i];
-            descriptorWrites[0].dstBinding = 0;
-            descriptorWrites[0].dstArrayElement = 0;
-            descriptorWrites[0].descriptorType = vk::DescriptorType::eUniformBuffer;
-            descriptorWrites[0].descriptorCount = 1;
-            descriptorWrites[0].pBufferInfo = &descriptorBufferInfo;
+        getDevice().updateDescriptorSets(descriptorWrite, {});
+        frameDataVersions[imageIndex] = getFrameDataVersion();
+    }
 
-            descriptorWrites[1].dstSet = descriptorSets[i];
-            descriptorWrites[1].dstBinding = 1;
-            descriptorWrites[1].dstArrayElement = 0;
-            descriptorWrites[1].descriptorType = vk::DescriptorType::eCombinedImageSampler;
-            descriptorWrites[1].descriptorCount = 1;
-            descriptorWrites[1].pImageInfo = &imageInfo;
+    RecordingPart::RecordingPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)), threadPool(std::max<size_t>(getCreateInfo().recordingThreads, 1) - 1) {
+        for (size_t i = 0; i < getMaxFramesInFlight() * threadPool.getThreadCount(); ++i) {
+            vk::CommandPoolCreateInfo commandPoolInfo;
+            commandPoolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+            commandPoolInfo.queueFamilyIndex = getGraphicsQueueFamilyIndex();
+            commandPools.push_back(getDevice().createCommandPoolUnique(commandPoolInfo));
 
-            getDevice().updateDescriptorSets(descriptorWrites, {});
+            vk::CommandBufferAllocateInfo allocateInfo;
+            allocateInfo.commandPool = *commandPools.back();
+            allocateInfo.level = vk::CommandBufferLevel::eSecondary;
+            allocateInfo.commandBufferCount = 1;
+            uniqueCommandBuffers.push_back(std::move(getDevice().allocateCommandBuffersUnique(allocateInfo)[0]));
+            commandBuffers.push_back(*uniqueCommandBuffers.back());
         }
     }
 
-    auto DescriptorSetsPart::rebuildDescriptorSets() -> void {
-        getDevice().freeDescriptorSets(getDescriptorPool(), descriptorSets);
-        buildDescriptorSets();
-    }
+    auto RecordingPart::recordSecondaryDraws(size_t frame, size_t imageIndex, uint32_t uboOffset) -> std::span<const vk::CommandBuffer> {
+        std::span<const Draw> draws = getDraws();
+        size_t slots = threadPool.getThreadCount();
+        size_t chunks = std::clamp<size_t>((draws.size() + minDrawsPerChunk - 1) / minDrawsPerChunk, 1, slots);
+        size_t first = frame * slots;
 
-    auto DescriptorSetsPart::getDescriptorSets() -> const std::vector<vk::DescriptorSet>& {
-        return descriptorSets;
+        threadPool.run(chunks, [&](size_t chunk) {
+            getDevice().resetCommandPool(*commandPools[first + chunk], {});
+
+            vk::CommandBufferInheritanceInfo inheritanceInfo;
+            inheritanceInfo.renderPass = getRenderPass();
+            inheritanceInfo.subpass = 0;
+            inheritanceInfo.framebuffer = getFramebuffer(imageIndex);
+
+            vk::CommandBufferBeginInfo beginInfo;
+            beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+            beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+            vk::CommandBuffer commandBuffer = commandBuffers[first + chunk];
+            commandBuffer.begin(beginInfo);
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, getGraphicsPipeline());
+            std::array sets = { getDescriptorSets()[imageIndex], getTextureSet() };
+            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, getGraphicsPipelineLayout(), 0, sets, uboOffset);
+
+            size_t begin = draws.size() * chunk / chunks;
+            size_t end = draws.size() * (chunk + 1) / chunks;
+            recordDraws(commandBuffer, draws.subspan(begin, end - begin));
+
+            commandBuffer.end();
+        });
+
+        return std::span<const vk::CommandBuffer>(commandBuffers).subspan(first, chunks);
     }
 
     LoopPart::LoopPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {
@@ -1230,15 +2652,45 @@ namespace vkr::part {
         vk::FenceCreateInfo fenceInfo;
         fenceInfo.flags = vk::FenceCreateFlagBits::eSignaled;
 
-        for (uint32_t i = 0; i < maxFramesInFlight; ++i) {
+        for (uint32_t i = 0; i < getMaxFramesInFlight(); ++i) {
             imageAvailableSemaphores.push_back(getDevice().createSemaphoreUnique(semaphoreInfo));
             renderFinishedSemaphores.push_back(getDevice().createSemaphoreUnique(semaphoreInfo));
             fencesInFlight.push_back(getDevice().createFenceUnique(fenceInfo));
         }
 
-        commandBuffers.resize(maxFramesInFlight);
+        for (uint32_t i = 0; i < getMaxFramesInFlight(); ++i) {
+            vk::CommandPoolCreateInfo commandPoolInfo;
+            commandPoolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+            commandPoolInfo.queueFamilyIndex = getGraphicsQueueFamilyIndex();
+            commandPools.push_back(getDevice().createCommandPoolUnique(commandPoolInfo));
+
+            vk::CommandBufferAllocateInfo allocateInfo;
+            allocateInfo.commandPool = *commandPools.back();
+            allocateInfo.level = vk::CommandBufferLevel::ePrimary;
+            allocateInfo.commandBufferCount = 1;
+            commandBuffers.push_back(std::move(getDevice().allocateCommandBuffersUnique(allocateInfo)[0]));
+        }
+
+        readbackBuffers.resize(getMaxFramesInFlight());
+        readbackPending.resize(getMaxFramesInFlight());
+        frameNumbers.resize(getMaxFramesInFlight());
+
+        if (getPhysicalDevice().getQueueFamilyProperties()[getGraphicsQueueFamilyIndex()].timestampValidBits != 0) {
+            timestampPeriod = getPhysicalDevice().getProperties().limits.timestampPeriod;
+
+            vk::QueryPoolCreateInfo queryPoolInfo;
+            queryPoolInfo.queryType = vk::QueryType::eTimestamp;
+            queryPoolInfo.queryCount = getMaxFramesInFlight() * 2;
+            timestampQueryPool = getDevice().createQueryPoolUnique(queryPoolInfo);
+        }
 
         framebufferExtent = getCurrentExtent();
+        startTime = std::chrono::steady_clock::now();
+        lastUpdate = startTime;
+
+        if (getCreateInfo().headless) {
+            return;
+        }
 
         getWindowHandle().onRefresh = [&]() {
             update();
@@ -1255,7 +2707,13 @@ namespace vkr::part {
             return;
         }
 
+        bool headless = getCreateInfo().headless;
+
         getDevice().waitForFences(*fencesInFlight[static_cast<size_t>(currentFrame)], true, std::numeric_limits<uint64_t>::max());
+        collectUploads();
+        collectDeferred(frameNumbers[static_cast<size_t>(currentFrame)]);
+        completeFrame(static_cast<size_t>(currentFrame));
+        beginFrameData(static_cast<size_t>(currentFrame));
 
         if (rebuildIsNeeded) {
             double now = glfw::glfwGetTime();
@@ -1265,40 +2723,36 @@ namespace vkr::part {
             }
         }
 
-        uint32_t imageIndex = 0;
-        try {
-            auto [result, index] = getDevice().acquireNextImageKHR(getSwapchain(), std::numeric_limits<uint64_t>::max(), *imageAvailableSemaphores[static_cast<size_t>(currentFrame)], {});
-            if (result != vk::Result::eSuccess) {
+        uint32_t imageIndex = currentFrame % static_cast<uint32_t>(getSwapchainImageCount());
+        if (!headless) {
+            try {
+                auto [result, index] = getDevice().acquireNextImageKHR(getSwapchain(), std::numeric_limits<uint64_t>::max(), *imageAvailableSemaphores[static_cast<size_t>(currentFrame)], {});
+                if (result != vk::Result::eSuccess) {
+                    rebuildForResize();
+                    return;
+                }
+                imageIndex = index;
+            }
+            catch (...) {
                 rebuildForResize();
                 return;
             }
-            imageIndex = index;
-        }
-        catch (...) {
-            rebuildForResize();
-            return;
         }
 
-        {
-            static auto last = static_cast<float>(glfw::glfwGetTime());
-            float now = static_cast<float>(glfw::glfwGetTime());
-            getCreateInfo().onUpdate(now - last, now);
-            last = now;
+        data::UBO ubo;
 
-            if (getVertexBuffer() != VK_NULL_HANDLE) {
-                updateStagingBuffer();
-            }
+        {
+            auto now = std::chrono::steady_clock::now();
+            getCreateInfo().onUpdate(std::chrono::duration<float>(now - lastUpdate).count(), std::chrono::duration<float>(now - startTime).count());
+            lastUpdate = now;
 
-            data::UBO ubo;
+            flushUploads();
 
             glm::mat4 rotation = glm::eulerAngleXZ(camera.pitch, camera.yaw);
 
             ubo.view = rotation * glm::translate(glm::mat4(1.0f), camera.position * glm::vec3(1.0f, -1.0f, 1.0f));
             ubo.projection = glm::perspective(camera.fov, static_cast<float>(currentExtent.width) / static_cast<float>(currentExtent.height), 0.01f, 1000.0f);
 
-            void* data = getDevice().mapMemory(getUniformBuffersMemory()[static_cast<size_t>(imageIndex)], 0, sizeof(data::UBO));
-            memcpy(data, &ubo, sizeof(data::UBO));
-            getDevice().unmapMemory(getUniformBuffersMemory()[static_cast<size_t>(imageIndex)]);
         }
 
         if (imagesInFlight[static_cast<size_t>(imageIndex)] != VK_NULL_HANDLE) {
@@ -1312,27 +2766,41 @@ namespace vkr::part {
         std::array waitSemaphores = { *imageAvailableSemaphores[static_cast<size_t>(currentFrame)] };
         std::array waitStages = { vk::PipelineStageFlags(vk::PipelineStageFlagBits::eColorAttachmentOutput) };
 
-        submitInfo.waitSemaphoreCount = (uint32_t)(waitSemaphores.size());
+        submitInfo.waitSemaphoreCount = headless ? 0 : (uint32_t)(waitSemaphores.size());
         submitInfo.pWaitSemaphores = waitSemaphores.data();
         submitInfo.pWaitDstStageMask = waitStages.data();
 
         submitInfo.commandBufferCount = 1;
 
-        {
-            vk::CommandBufferAllocateInfo allocateInfo;
-            allocateInfo.commandPool = getCommandPool();
-            allocateInfo.level = vk::CommandBufferLevel::ePrimary;
-            allocateInfo.commandBufferCount = 1;
+        vk::CommandBuffer commandBuffer = *commandBuffers[static_cast<size_t>(currentFrame)];
 
-            commandBuffers[imageIndex] = std::move(getDevice().allocateCommandBuffersUnique(allocateInfo)[0]);
+        {
+            getDevice().resetCommandPool(*commandPools[static_cast<size_t>(currentFrame)], {});
 
             vk::CommandBufferBeginInfo beginInfo;
             beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
-            commandBuffers[imageIndex]->begin(beginInfo);
+            commandBuffer.begin(beginInfo);
+
+            if (timestampQueryPool) {
+                commandBuffer.resetQueryPool(*timestampQueryPool, currentFrame * 2, 2);
+                commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, *timestampQueryPool, currentFrame * 2);
+            }
+
+            glm::vec3 eye = glm::vec3(glm::inverse(ubo.view)[3]);
+
+            recordVertexUpdates(commandBuffer);
+            recordTextureMipmaps(commandBuffer);
+            selectLods(eye, std::abs(ubo.projection[1][1]) * static_cast<float>(currentExtent.height) * 0.5f);
+            prepareInstances();
+            recordCulling(commandBuffer, static_cast<size_t>(currentFrame), ubo.projection * ubo.view, eye);
+
+            // Pushed last, so it lands in the same buffer the set is updated to even if the ring grew this frame.
+            auto uboOffset = static_cast<uint32_t>(pushFrameData(ubo));
+            updateDescriptorSet(static_cast<size_t>(imageIndex));
 
             vk::RenderPassBeginInfo renderPassInfo;
             renderPassInfo.renderPass = getRenderPass();
-            renderPassInfo.framebuffer = getFramebuffers()[imageIndex];
+            renderPassInfo.framebuffer = getFramebuffer(static_cast<size_t>(imageIndex));
             renderPassInfo.renderArea.offset.x = 0;
             renderPassInfo.renderArea.offset.y = 0;
             renderPassInfo.renderArea.extent = framebufferExtent;
@@ -1343,39 +2811,47 @@ namespace vkr::part {
             renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
             renderPassInfo.pClearValues = clearValues.data();
 
-            commandBuffers[imageIndex]->beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
-            {
-                commandBuffers[imageIndex]->bindPipeline(vk::PipelineBindPoint::eGraphics, getGraphicsPipeline());
-
-                if (getVertexBuffer() != VK_NULL_HANDLE) {
-                    commandBuffers[imageIndex]->bindVertexBuffers(0, getVertexBuffer(), static_cast<vk::DeviceSize>(0));
-                }
-
-                if (getIndexBuffer() != VK_NULL_HANDLE) {
-                    commandBuffers[imageIndex]->bindIndexBuffer(getIndexBuffer(), 0, vk::IndexType::eUint32);
-                }
+            if (getCullingEnabled()) {
+                commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+                commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, getGraphicsPipeline());
+                std::array sets = { getDescriptorSets()[imageIndex], getTextureSet() };
+                commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, getGraphicsPipelineLayout(), 0, sets, uboOffset);
+                recordIndirectDraws(commandBuffer, static_cast<size_t>(currentFrame));
+            }
+            else {
+                commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eSecondaryCommandBuffers);
+                commandBuffer.executeCommands(recordSecondaryDraws(static_cast<size_t>(currentFrame), static_cast<size_t>(imageIndex), uboOffset));
+            }
+            commandBuffer.endRenderPass();
 
-                commandBuffers[imageIndex]->bindDescriptorSets(vk::PipelineBindPoint::eGraphics, getGraphicsPipelineLayout(), 0, 1, &getDescriptorSets()[imageIndex], 0, nullptr);
+            if (headless) {
+                recordReadback(commandBuffer, static_cast<size_t>(currentFrame), static_cast<size_t>(imageIndex));
+            }
 
-                if (getVertexBuffer() != VK_NULL_HANDLE && getIndexBuffer() != VK_NULL_HANDLE) {
-                    commandBuffers[imageIndex]->drawIndexed(static_cast<uint32_t>(getIndexCount()), 1, 0, 0, 0);
-                }
+            if (timestampQueryPool) {
+                commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *timestampQueryPool, currentFrame * 2 + 1);
             }
-            commandBuffers[imageIndex]->endRenderPass();
 
-            commandBuffers[imageIndex]->end();
+            commandBuffer.end();
         }
 
-        submitInfo.pCommandBuffers = &*commandBuffers[imageIndex];
+        submitInfo.pCommandBuffers = &commandBuffer;
 
         std::array signalSemaphores = { *renderFinishedSemaphores[static_cast<size_t>(currentFrame)] };
-        submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+        submitInfo.signalSemaphoreCount = headless ? 0 : static_cast<uint32_t>(signalSemaphores.size());
 
         submitInfo.pSignalSemaphores = signalSemaphores.data();
 
         getDevice().resetFences(*fencesInFlight[static_cast<size_t>(currentFrame)]);
 
         getGraphicsQueue().submit(submitInfo, *fencesInFlight[static_cast<size_t>(currentFrame)]);
+        frameNumbers[static_cast<size_t>(currentFrame)] = ++frameNumber;
+        markFrameSubmitted(frameNumber);
+
+        if (headless) {
+            currentFrame = (currentFrame + 1) % getMaxFramesInFlight();
+            return;
+        }
 
         vk::PresentInfoKHR presentInfo;
         presentInfo.waitSemaphoreCount = (uint32_t)(signalSemaphores.size());
@@ -1398,7 +2874,7 @@ namespace vkr::part {
             return;
         }
 
-        currentFrame = (currentFrame + 1) % maxFramesInFlight;
+        currentFrame = (currentFrame + 1) % getMaxFramesInFlight();
     }
 
     auto LoopPart::rebuildForResize() -> void {
@@ -1414,21 +2890,89 @@ namespace vkr::part {
         buildColorResources(extent);
         buildDepthBuffer(extent);
         buildFramebuffers(extent);
-        buildUniformBuffers();
         buildDescriptorPool();
         buildDescriptorSets();
-        for (vk::UniqueCommandBuffer& commandBuffer : commandBuffers) {
-            commandBuffer.reset();
-        }
         rebuildIsNeeded = false;
     }
 
+    auto LoopPart::finishFrames() -> void {
+        getDevice().waitIdle();
+        collectDeferred(frameNumber);
+        for (uint32_t i = 0; i < getMaxFramesInFlight(); ++i) {
+            completeFrame(static_cast<size_t>((currentFrame + i) % getMaxFramesInFlight()));
+        }
+    }
+
+    auto LoopPart::recordReadback(vk::CommandBuffer commandBuffer, size_t frame, size_t imageIndex) -> void {
+        vk::DeviceSize size = static_cast<vk::DeviceSize>(framebufferExtent.width) * framebufferExtent.height * 4;
+        reserveBuffer(readbackBuffers[frame], size, vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+        vk::BufferImageCopy region;
+        region.bufferOffset = 0;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = vk::Offset3D(0, 0, 0);
+        region.imageExtent = vk::Extent3D(framebufferExtent.width, framebufferExtent.height, 1);
+
+        commandBuffer.copyImageToBuffer(getSwapchainImage(imageIndex), vk::ImageLayout::eTransferSrcOptimal, *readbackBuffers[frame].buffer, region);
+
+        vk::MemoryBarrier barrier;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, barrier, {}, {});
+
+        readbackPending[frame] = true;
+    }
+
+    auto LoopPart::completeFrame(size_t frame) -> void {
+        if (frameNumbers[frame] == 0) {
+            return;
+        }
+
+        if (timestampQueryPool) {
+            std::array<uint64_t, 2> timestamps = {};
+            vk::Result result = getDevice().getQueryPoolResults(*timestampQueryPool, static_cast<uint32_t>(frame * 2), 2, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+            if (result == vk::Result::eSuccess) {
+                getCreateInfo().onGpuTime(frameNumbers[frame], static_cast<double>(timestamps[1] - timestamps[0]) * timestampPeriod / 1e6);
+            }
+        }
+
+        frameNumbers[frame] = 0;
+
+        if (!readbackPending[frame]) {
+            return;
+        }
+        readbackPending[frame] = false;
+
+        size_t size = static_cast<size_t>(framebufferExtent.width) * framebufferExtent.height * 4;
+        auto pixels = static_cast<const uint8_t*>(readbackBuffers[frame].memory.getMapped());
+        getCreateInfo().onFrame(std::span<const uint8_t>(pixels, size), glm::uvec2(framebufferExtent.width, framebufferExtent.height));
+    }
+
     auto LoopPart::getCamera() -> data::Camera& {
         return camera;
     }
 
     LastPart::LastPart(api::RendererCreateInfo&& rendererCreateInfo) : Base(std::move(rendererCreateInfo)) {}
 
+    auto LastPart::renderFrame() -> void {
+        if (!getCreateInfo().headless) {
+            getWindowHandle().poll();
+        }
+        update();
+    }
+
+    auto LastPart::runFrames(size_t count) -> void {
+        for (size_t i = 0; i < count; ++i) {
+            renderFrame();
+        }
+        finishFrames();
+    }
+
     auto LastPart::runLoop() -> void {
         getWindowHandle().getWindow().show();
         while (!getWindowHandle().getWindow().getClosed()) {
@@ -2,6 +2,11 @@
 #include "math.h"
 #include "algorithm.h"
 #include "meta.h"
+#include "memory.h"
+#include "parallel.h"
+#include "meshlet.h"
+#include "bc.h"
+#include "mip.h"
 #include "io.h"
 #include "data.h"
 #include "api.h"
@@ -46,7 +51,7 @@ namespace vkr::part {
         auto getWindowHandle() -> io::WindowHandle&;
     private:
         vk::UniqueSurfaceKHR surface;
-        io::WindowHandle windowHandle;
+        std::optional<io::WindowHandle> windowHandle;
     };
 
     class PhysicalDevicePart : public SurfacePart {
@@ -58,10 +63,13 @@ namespace vkr::part {
         auto getQueueFamilyIndices() -> const std::array<uint32_t, 2>&;
         auto getGraphicsQueueFamilyIndex() -> uint32_t;
         auto getPresentQueueFamilyIndex() -> uint32_t;
+        auto getTransferQueueFamilyIndex() -> uint32_t;
     private:
+        static auto getMissingFeatures(vk::PhysicalDevice device) -> std::string;
         vk::PhysicalDevice device;
         std::vector<const char*> extentions;
         std::array<uint32_t, 2> queueFamilyIndices = {};
+        uint32_t transferQueueFamilyIndex = 0;
     };
 
     class PhysicalDeviceDataPart : public PhysicalDevicePart {
@@ -81,6 +89,12 @@ namespace vkr::part {
         vk::SampleCountFlagBits msaaSamples;
     };
 
+    struct GrowableBuffer {
+        vk::UniqueBuffer buffer;
+        memory::Allocation memory;
+        vk::DeviceSize capacity = 0;
+    };
+
     class DevicePart : public PhysicalDeviceDataPart {
     public:
         using Base = PhysicalDeviceDataPart;
@@ -88,11 +102,17 @@ namespace vkr::part {
         auto getDevice() -> vk::Device;
         auto getGraphicsQueue() -> vk::Queue;
         auto getPresentQueue() -> vk::Queue;
-        auto makeBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties) -> std::tuple<vk::UniqueBuffer, vk::UniqueDeviceMemory>;
-        auto makeImage(glm::uvec2 size, uint32_t mipLevels, vk::SampleCountFlagBits sampleCount, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties) -> std::tuple<vk::UniqueImage, vk::UniqueDeviceMemory>;
-        auto makeImageView(vk::Image image, vk::Format format, vk::ImageAspectFlagBits aspectFlags, uint32_t mipLevels) -> vk::UniqueImageView;
+        auto getTransferQueue() -> vk::Queue;
+        auto getAllocator() -> memory::Allocator&;
+        auto getDrawIndirectCount() -> bool;
+        auto makeBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties) -> std::tuple<vk::UniqueBuffer, memory::Allocation>;
+        auto reserveBuffer(GrowableBuffer& buffer, vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties) -> bool;
+        auto makeImage(glm::uvec2 size, uint32_t mipLevels, vk::SampleCountFlagBits sampleCount, vk::Format format, vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, vk::ImageCreateFlags flags = {}) -> std::tuple<vk::UniqueImage, memory::Allocation>;
+        auto makeImageView(vk::Image image, vk::Format format, vk::ImageAspectFlagBits aspectFlags, uint32_t mipLevels, vk::ImageUsageFlags usage = {}) -> vk::UniqueImageView;
     private:
         vk::UniqueDevice device;
+        std::unique_ptr<memory::Allocator> allocator;
+        bool drawIndirectCount = false;
     };
 
     class SwapchainPart : public DevicePart {
@@ -114,10 +134,14 @@ namespace vkr::part {
         ImagesPart(api::RendererCreateInfo&& rendererCreateInfo);
         auto getSwapchainImageViews() -> std::vector<vk::ImageView>;
         auto getSwapchainImageCount() -> size_t;
+        auto getSwapchainImage(size_t index) -> vk::Image;
     public:
         auto buildImages(vk::Extent2D extent) -> void;
     private:
+        static constexpr size_t offscreenImageCount = 2;
         std::vector<vk::Image> images;
+        std::vector<vk::UniqueImage> offscreenImages;
+        std::vector<memory::Allocation> offscreenImagesMemory;
         std::vector<vk::UniqueImageView> uniqueImageViews;
     };
 
@@ -135,8 +159,13 @@ namespace vkr::part {
         using Base = RenderPassPart;
         DescriptorSetLayoutPart(api::RendererCreateInfo&& rendererCreateInfo);
         auto getDescriptorSetLayout() -> vk::DescriptorSetLayout;
+        auto getTextureSetLayout() -> vk::DescriptorSetLayout;
+        auto getTextureCapacity() -> uint32_t;
     private:
+        static constexpr uint32_t maxTextureCapacity = 4096;
         vk::UniqueDescriptorSetLayout descriptorSetLayout;
+        vk::UniqueDescriptorSetLayout textureSetLayout;
+        uint32_t textureCapacity = 0;
     };
 
     class GraphicsPipelinePart : public DescriptorSetLayoutPart {
@@ -156,48 +185,99 @@ namespace vkr::part {
     public:
         using Base = GraphicsPipelinePart;
         CommandPoolPart(api::RendererCreateInfo&& rendererCreateInfo);
-        auto getCommandPool() -> vk::CommandPool;
-        auto copyBuffer(vk::Buffer from, vk::Buffer to, vk::DeviceSize size) -> void;
-        auto transitionImageLayout(vk::Image image, vk::Format format, vk::ImageLayout oldLayout, vk::ImageLayout newLayout, uint32_t mipLevels) -> void;
-        auto copyBufferToImage(vk::Buffer buffer, vk::Image image, glm::uvec2 size) -> void;
-        template <class Callback>
-        auto executeSingleTimeCommands(Callback callback) -> void {
-            vk::CommandBufferAllocateInfo commandBufferAllocateInfo;
-            commandBufferAllocateInfo.level = vk::CommandBufferLevel::ePrimary;
-            commandBufferAllocateInfo.commandPool = *commandPool;
-            commandBufferAllocateInfo.commandBufferCount = 1;
-
-            vk::UniqueCommandBuffer commandBuffer = std::move(getDevice().allocateCommandBuffersUnique(commandBufferAllocateInfo)[0]);
-
-            vk::CommandBufferBeginInfo commandBufferBeginInfo;
-            commandBufferBeginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
-
-            commandBuffer->begin(commandBufferBeginInfo);
-            callback(*commandBuffer);
-            commandBuffer->end();
-
-            vk::SubmitInfo submitInfo;
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers = &*commandBuffer;
+        auto copyBuffer(vk::CommandBuffer commandBuffer, vk::Buffer from, vk::Buffer to, vk::DeviceSize size) -> void;
+        auto transitionImageLayout(vk::CommandBuffer commandBuffer, vk::Image image, vk::Format format, vk::ImageLayout oldLayout, vk::ImageLayout newLayout, uint32_t mipLevels) -> void;
+        auto copyBufferToImage(vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize offset, vk::Image image, glm::uvec2 size, uint32_t mipLevel) -> void;
+        auto blitMipmaps(vk::CommandBuffer commandBuffer, vk::Image image, vk::Format format, glm::ivec2 size, uint32_t mipLevels, vk::ImageLayout layout, vk::PipelineStageFlags sourceStage, vk::AccessFlags sourceAccess) -> void;
+    };
 
-            getGraphicsQueue().submit(submitInfo, {});
-            getGraphicsQueue().waitIdle();
+    class UploadPart : public CommandPoolPart {
+    public:
+        using Base = CommandPoolPart;
+        UploadPart(api::RendererCreateInfo&& rendererCreateInfo);
+        auto getTransferCommandBuffer() -> vk::CommandBuffer;
+        auto getUploadCommandBuffer() -> vk::CommandBuffer;
+        auto getDedicatedTransfer() -> bool;
+        auto makeStagingBuffer(vk::DeviceSize size) -> std::tuple<vk::Buffer, void*>;
+        auto releaseBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize size, vk::AccessFlags dstAccess) -> void;
+        auto releaseImage(vk::Image image, vk::ImageLayout layout, uint32_t mipLevels, vk::AccessFlags dstAccess) -> void;
+        auto flushUploads() -> void;
+        auto collectUploads() -> void;
+        template <class T>
+        auto retire(T&& resource) -> void {
+            if (recording) {
+                recording->resources.push_back(std::make_shared<std::decay_t<T>>(std::move(resource)));
+            }
+        }
+    private:
+        struct UploadBatch {
+            vk::UniqueCommandBuffer transferCommandBuffer;
+            vk::UniqueCommandBuffer commandBuffer;
+            vk::UniqueSemaphore semaphore;
+            vk::UniqueFence fence;
+            std::vector<std::shared_ptr<void>> resources;
+            bool transferRecorded = false;
         };
-        auto generateMipmaps(vk::Image image, vk::Format imageFormat, glm::ivec2 dimentionsBeforeFullscreen, uint32_t mipLevels) -> void;
+        auto beginBatch() -> void;
+        bool dedicatedTransfer = false;
+        vk::UniqueCommandPool transferCommandPool;
+        vk::UniqueCommandPool uploadCommandPool;
+        std::optional<UploadBatch> recording;
+        std::deque<UploadBatch> batchesInFlight;
+        std::vector<UploadBatch> freeBatches;
+    };
+
+    class FrameDataPart : public UploadPart {
+    public:
+        using Base = UploadPart;
+        FrameDataPart(api::RendererCreateInfo&& rendererCreateInfo);
+        auto getMaxFramesInFlight() -> uint32_t;
+        auto getFrameDataBuffer() -> vk::Buffer;
+        auto getFrameDataVersion() -> uint64_t;
+        auto beginFrameData(size_t frame) -> void;
+        auto allocateFrameData(vk::DeviceSize size) -> std::tuple<vk::DeviceSize, void*>;
+        template <class T>
+        auto pushFrameData(const T& value) -> vk::DeviceSize {
+            auto [offset, mapped] = allocateFrameData(sizeof(T));
+            memcpy(mapped, &value, sizeof(T));
+            return offset;
+        }
+        // Uploads flushed before the next frame may still read the resource, so it waits for that frame's fence.
+        template <class T>
+        auto deferDestruction(T&& resource) -> void {
+            deferredResources.push_back({ submittedFrameNumber + 1, std::make_shared<std::decay_t<T>>(std::move(resource)) });
+        }
+        auto markFrameSubmitted(uint64_t frameNumber) -> void;
+        auto collectDeferred(uint64_t completedFrameNumber) -> void;
     private:
-        vk::UniqueCommandPool commandPool;
+        struct DeferredResource {
+            uint64_t frameNumber = 0;
+            std::shared_ptr<void> resource;
+        };
+        auto buildFrameData(vk::DeviceSize size) -> void;
+        uint32_t maxFramesInFlight = 2;
+        vk::DeviceSize alignment = 256;
+        vk::DeviceSize frameSize = 0;
+        size_t frameIndex = 0;
+        vk::DeviceSize head = 0;
+        vk::DeviceSize end = 0;
+        vk::UniqueBuffer buffer;
+        memory::Allocation memory;
+        uint64_t version = 0;
+        uint64_t submittedFrameNumber = 0;
+        std::deque<DeferredResource> deferredResources;
     };
 
-    class ColorResourcesPart : public CommandPoolPart {
+    class ColorResourcesPart : public FrameDataPart {
     public:
-        using Base = CommandPoolPart;
+        using Base = FrameDataPart;
         ColorResourcesPart(api::RendererCreateInfo&& rendererCreateInfo);
         auto getColorImageView() -> vk::ImageView;
     public:
         auto buildColorResources(vk::Extent2D extent) -> void;
     private:
         vk::UniqueImage colorImage;
-        vk::UniqueDeviceMemory colorImageMemory;
+        memory::Allocation colorImageMemory;
         vk::UniqueImageView colorImageView;
     };
 
@@ -210,7 +290,7 @@ namespace vkr::part {
         auto buildDepthBuffer(vk::Extent2D extent) -> void;
     private:
         vk::UniqueImage depthImage;
-        vk::UniqueDeviceMemory depthImageMemory;
+        memory::Allocation depthImageMemory;
         vk::UniqueImageView depthImageView;
     };
 
@@ -218,66 +298,182 @@ namespace vkr::part {
     public:
         using Base = DepthPart;
         FramebufferPart(api::RendererCreateInfo&& rendererCreateInfo);
-        auto getFramebuffers() -> std::vector<vk::Framebuffer>;
+        auto getFramebuffer(size_t index) -> vk::Framebuffer;
     public:
         auto buildFramebuffers(vk::Extent2D extent) -> void;
     private:
         std::vector<vk::UniqueFramebuffer> framebuffers;
     };
 
-    class TexturePart : public FramebufferPart {
+    // Builds the levels of RGBA8 images whose level 0 is written on the GPU, with blits or with mipmap.comp as
+    // selected by RendererCreateInfo::mipGenerator.
+    class MipmapPart : public FramebufferPart {
     public:
         using Base = FramebufferPart;
+        MipmapPart(api::RendererCreateInfo&& rendererCreateInfo);
+        struct MipmapImage {
+            vk::Image image;
+            vk::Format format = vk::Format::eUndefined;
+            glm::ivec2 size = glm::ivec2(0);
+            uint32_t mipLevels = 1;
+            vk::UniqueDescriptorPool descriptorPool;
+            vk::DescriptorSet descriptorSet;
+            std::vector<vk::UniqueImageView> views;
+        };
+        auto getMipmapImageUsage() -> vk::ImageUsageFlags;
+        auto getMipmapImageFlags(vk::Format format) -> vk::ImageCreateFlags;
+        auto makeMipmapImage(vk::Image image, vk::Format format, glm::ivec2 size, uint32_t mipLevels) -> MipmapImage;
+        auto generateMipmaps(vk::CommandBuffer commandBuffer, const MipmapImage& target, vk::ImageLayout layout) -> void;
+    private:
+        static constexpr uint32_t maxComputeLevels = 13;
+        auto getComputeSupported(const MipmapImage& target) -> bool;
+        auto dispatchMipmaps(vk::CommandBuffer commandBuffer, const MipmapImage& target, vk::ImageLayout layout, vk::PipelineStageFlags sourceStage, vk::AccessFlags sourceAccess) -> void;
+        vk::UniqueDescriptorSetLayout mipmapDescriptorSetLayout;
+        vk::UniquePipelineLayout mipmapLayout;
+        vk::UniquePipeline mipmapPipeline;
+        vk::UniqueSampler mipmapSampler;
+        vk::UniqueBuffer mipmapCounter;
+        memory::Allocation mipmapCounterMemory;
+    };
+
+    // Every texture lives in one descriptor array that shaders index with the texture of the instance being drawn.
+    // Texture 0 is the default every instance starts with.
+    class TexturePart : public MipmapPart {
+    public:
+        using Base = MipmapPart;
         TexturePart(api::RendererCreateInfo&& rendererCreateInfo);
-        auto getTextureImageView() -> const vk::ImageView&;
-        auto getTextureSampler() -> const vk::Sampler&;
-        auto setTexture(const data::Texture& texture) -> void;
+        auto getTextureSet() -> vk::DescriptorSet;
+        auto getTextureCount() -> uint32_t;
+        auto getTextureDescriptor(uint32_t texture) -> uint32_t;
+        auto pushTexture(const data::Texture& texture, bool dynamic = false) -> uint32_t;
+        auto setTexture(uint32_t texture, const data::Texture& data, bool dynamic = false) -> void;
+        auto markTextureDirty(uint32_t texture) -> void;
+        auto recordTextureMipmaps(vk::CommandBuffer commandBuffer) -> void;
     private:
-        uint32_t mipLevels;
-        vk::UniqueImage image;
-        vk::UniqueDeviceMemory memory;
-        vk::UniqueImageView textureImageView;
+        struct TextureSlot {
+            vk::UniqueImage image;
+            memory::Allocation memory;
+            vk::UniqueImageView view;
+            std::optional<MipmapImage> mipmapImage;
+            uint32_t descriptor = 0;
+            bool dirty = false;
+        };
+        auto uploadTexture(TextureSlot& slot, const data::Texture& texture, bool dynamic) -> void;
+        auto allocateDescriptor() -> uint32_t;
         vk::UniqueSampler sampler;
+        vk::UniqueDescriptorPool textureDescriptorPool;
+        vk::DescriptorSet textureSet;
+        std::vector<TextureSlot> textures;
+        std::shared_ptr<std::vector<uint32_t>> freeDescriptors = std::make_shared<std::vector<uint32_t>>();
+        uint32_t descriptorCount = 0;
     };
 
     class ModelDataPart : public TexturePart {
     public:
         using Base = TexturePart;
         ModelDataPart(api::RendererCreateInfo&& rendererCreateInfo);
-        ~ModelDataPart();
-        auto pushModel(const data::Model& data) -> void;
+        auto pushModel(const data::Model& data) -> uint32_t;
         auto getVertexBuffer() -> const vk::Buffer&;
         auto getIndexCount() -> size_t;
         auto getIndexBuffer() -> const vk::Buffer&;
-        auto getVertexSpan() -> std::span<data::Vertex>;
-        auto updateStagingBuffer() -> void;
+        auto getIndexType() -> vk::IndexType;
+        auto getMeshletBuffer() -> vk::Buffer;
+        auto getMesh(uint32_t mesh) -> const data::Mesh&;
+        auto getMeshCount() -> size_t;
+        auto getVertexSpan() -> std::span<const data::Vertex>;
+        auto getVertexSpan(size_t offset, size_t count) -> std::span<data::Vertex>;
+        auto markDirty(size_t offset, size_t count) -> void;
+        auto recordVertexUpdates(vk::CommandBuffer commandBuffer) -> void;
     private:
-        data::Model model;
-        std::span<data::Vertex> vertexSpan;
-        vk::UniqueBuffer vertexStagingBuffer;
-        vk::UniqueDeviceMemory vertexStagingBufferMemory;
+        auto growBuffer(vk::UniqueBuffer& buffer, memory::Allocation& memory, vk::DeviceSize used, vk::DeviceSize capacity, vk::BufferUsageFlags usage) -> void;
+        data::ModelStore store;
+        vk::DeviceSize vertexCapacity = 0;
+        vk::DeviceSize indexCapacity = 0;
+        vk::DeviceSize meshletCapacity = 0;
+        std::vector<std::pair<size_t, size_t>> dirtyRanges;
+        std::vector<vk::BufferCopy> dirtyRegions;
         vk::UniqueBuffer vertexBuffer;
-        vk::UniqueDeviceMemory vertexBufferMemory;
+        memory::Allocation vertexBufferMemory;
         vk::UniqueBuffer indexBuffer;
-        vk::UniqueDeviceMemory indexBufferMemory;
+        memory::Allocation indexBufferMemory;
+        vk::UniqueBuffer meshletBuffer;
+        memory::Allocation meshletBufferMemory;
     };
 
-    class UniformBuffersPart : public ModelDataPart {
+    class InstancesPart : public ModelDataPart {
     public:
         using Base = ModelDataPart;
-        UniformBuffersPart(api::RendererCreateInfo&& rendererCreateInfo);
-        auto getUniformBuffers() -> std::vector<vk::Buffer>;
-        auto getUniformBuffersMemory() -> std::vector<vk::DeviceMemory>;
+        struct Draw {
+            uint32_t mesh = 0;
+            uint32_t instanceCount = 0;
+            uint32_t firstInstance = 0;
+        };
+        InstancesPart(api::RendererCreateInfo&& rendererCreateInfo);
+        auto addInstance(uint32_t mesh, const glm::mat4& transform, uint32_t texture = 0) -> uint32_t;
+        auto setInstanceTransform(uint32_t instance, const glm::mat4& transform) -> void;
+        auto setInstanceTexture(uint32_t instance, uint32_t texture) -> void;
+        auto removeInstance(uint32_t instance) -> void;
+        auto getInstanceCount() -> uint32_t;
+        auto prepareInstances() -> void;
+        auto getInstanceData() -> const vk::DescriptorBufferInfo&;
+        auto getObjectData() -> const vk::DescriptorBufferInfo&;
+        auto getMeshData() -> const vk::DescriptorBufferInfo&;
+        auto selectLods(const glm::vec3& camera, float projectionScale) -> void;
+        auto getDraws() -> std::span<const Draw>;
+        auto getTriangleCount() -> size_t;
+        auto recordDraws(vk::CommandBuffer commandBuffer, std::span<const Draw> draws) -> void;
+    private:
+        struct Slot {
+            uint32_t mesh = std::numeric_limits<uint32_t>::max();
+            uint32_t index = 0;
+            uint32_t lod = 0;
+        };
+        auto getSlot(uint32_t instance) -> Slot&;
+        auto detachInstance(const Slot& slot) -> void;
+        auto moveInstance(uint32_t instance, uint32_t mesh) -> void;
+        std::vector<std::vector<data::Instance>> meshInstances;
+        std::vector<std::vector<uint32_t>> meshInstanceHandles;
+        std::vector<Slot> slots;
+        std::vector<uint32_t> freeSlots;
+        vk::DescriptorBufferInfo instanceData;
+        vk::DescriptorBufferInfo objectData;
+        vk::DescriptorBufferInfo meshData;
+        std::vector<Draw> drawList;
+        size_t instanceCount = 0;
+        uint64_t version = 1;
+        uint64_t drawsVersion = 0;
+    };
+
+    class CullingPart : public InstancesPart {
     public:
-        auto buildUniformBuffers() -> void;
+        using Base = InstancesPart;
+        CullingPart(api::RendererCreateInfo&& rendererCreateInfo);
+        auto recordCulling(vk::CommandBuffer commandBuffer, size_t frame, const glm::mat4& viewProjection, const glm::vec3& camera) -> void;
+        auto recordIndirectDraws(vk::CommandBuffer commandBuffer, size_t frame) -> void;
+        auto getCullingEnabled() -> bool;
     private:
-        std::vector<vk::UniqueBuffer> uniformBuffers;
-        std::vector<vk::UniqueDeviceMemory> uniformBuffersMemory;
+        static constexpr size_t bindingCount = 8;
+        struct FrameCulling {
+            GrowableBuffer commands;
+            GrowableBuffer count;
+            GrowableBuffer visible;
+            GrowableBuffer dispatch;
+            uint32_t maxDrawCount = 0;
+            vk::UniqueDescriptorPool descriptorPool;
+            vk::DescriptorSet descriptorSet;
+            std::array<vk::DescriptorBufferInfo, bindingCount> bound = {};
+        };
+        auto buildCullingPipeline(const char* file) -> vk::UniquePipeline;
+        vk::UniqueDescriptorSetLayout descriptorSetLayout;
+        vk::UniquePipelineLayout layout;
+        vk::UniquePipeline pipeline;
+        vk::UniquePipeline clusterPipeline;
+        std::vector<FrameCulling> frameCulling;
     };
 
-    class DescriptorPoolPart : public UniformBuffersPart {
+    class DescriptorPoolPart : public CullingPart {
     public:
-        using Base = UniformBuffersPart;
+        using Base = CullingPart;
         DescriptorPoolPart(api::RendererCreateInfo&& rendererCreateInfo);
         auto getDescriptorPool() -> const vk::DescriptorPool&;
     public:
@@ -291,31 +487,56 @@ namespace vkr::part {
         using Base = DescriptorPoolPart;
         DescriptorSetsPart(api::RendererCreateInfo&& rendererCreateInfo);
         auto getDescriptorSets() -> const std::vector<vk::DescriptorSet>&;
+        auto updateDescriptorSet(size_t imageIndex) -> void;
     public:
         auto buildDescriptorSets() -> void;
-        auto rebuildDescriptorSets() -> void;
     private:
         std::vector<vk::DescriptorSet> descriptorSets;
+        std::vector<uint64_t> frameDataVersions;
     };
 
-    class LoopPart : public DescriptorSetsPart {
+    class RecordingPart : public DescriptorSetsPart {
     public:
         using Base = DescriptorSetsPart;
+        RecordingPart(api::RendererCreateInfo&& rendererCreateInfo);
+        auto recordSecondaryDraws(size_t frame, size_t imageIndex, uint32_t uboOffset) -> std::span<const vk::CommandBuffer>;
+    private:
+        static constexpr size_t minDrawsPerChunk = 256;
+        parallel::ThreadPool threadPool;
+        std::vector<vk::UniqueCommandPool> commandPools;
+        std::vector<vk::UniqueCommandBuffer> uniqueCommandBuffers;
+        std::vector<vk::CommandBuffer> commandBuffers;
+    };
+
+    class LoopPart : public RecordingPart {
+    public:
+        using Base = RecordingPart;
         LoopPart(api::RendererCreateInfo&& rendererCreateInfo);
         auto update() -> void;
         auto rebuildForResize() -> void;
+        auto finishFrames() -> void;
     public:
         auto getCamera() -> data::Camera&;
     private:
+        auto recordReadback(vk::CommandBuffer commandBuffer, size_t frame, size_t imageIndex) -> void;
+        auto completeFrame(size_t frame) -> void;
         bool rebuildIsNeeded = false;
         double lastRebuild = 0.0;
-        uint32_t maxFramesInFlight = 2;
         uint32_t currentFrame = 0;
+        std::vector<vk::UniqueCommandPool> commandPools;
         std::vector<vk::UniqueCommandBuffer> commandBuffers;
         std::vector<vk::UniqueSemaphore> imageAvailableSemaphores;
         std::vector<vk::UniqueSemaphore> renderFinishedSemaphores;
         std::vector<vk::UniqueFence> fencesInFlight;
         std::vector<vk::Fence> imagesInFlight;
+        std::vector<GrowableBuffer> readbackBuffers;
+        std::vector<bool> readbackPending;
+        vk::UniqueQueryPool timestampQueryPool;
+        float timestampPeriod = 1.0f;
+        std::vector<uint64_t> frameNumbers;
+        uint64_t frameNumber = 0;
+        std::chrono::steady_clock::time_point startTime;
+        std::chrono::steady_clock::time_point lastUpdate;
         data::Camera camera;
         vk::Extent2D framebufferExtent;
     };
@@ -325,5 +546,7 @@ namespace vkr::part {
         using Base = LoopPart;
         LastPart(api::RendererCreateInfo&& rendererCreateInfo);
         auto runLoop() -> void;
+        auto renderFrame() -> void;
+        auto runFrames(size_t count) -> void;
     };
 }
@@ -1,8 +1,5 @@
 VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tiny_obj_loader.h"
-
 namespace stb {
     #define STB_IMAGE_IMPLEMENTATION
     #include "stb_image.h"
@@ -8,14 +8,22 @@
 
 #include <algorithm>
 #include <any>
+#include <atomic>
+#include <charconv>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <math.h>
+#include <memory>
+#include <mutex>
 #include <numeric>
 #include <optional>
+#include <set>
 #include <thread>
 #include <typeindex>
 #include <typeinfo>
@@ -34,23 +42,37 @@
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtx/hash.hpp"
+#include "glm/gtx/norm.hpp"
 #include "glm/gtx/rotate_vector.hpp"
 #include "glm/gtx/quaternion.hpp"
 #include "glm/gtx/euler_angles.hpp"
+#include "glm/gtx/spline.hpp"
 #include "spdlog/spdlog.h"
 #include "vulkan/vulkan.hpp"
 
 namespace windows {
-    #include <Windows.h>
+    #ifdef _WIN32
+        #include <Windows.h>
+    #endif
 }
 
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <signal.h>
+    #include <unistd.h>
+#endif
+
+// Tools that never open a window, like the microbenchmarks, define VKR_NO_WINDOW and build without GLFW.
+#ifndef VKR_NO_WINDOW
 namespace glfw {
     using namespace windows;
     #include "GLFW/glfw3.h"
 }
+#endif
 
 namespace stb {
     #include "stb_image.h"
 }
 
-#include "tiny_obj_loader.h"
\ No newline at end of file
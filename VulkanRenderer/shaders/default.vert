@@ -8,14 +8,18 @@ layout(binding = 0) uniform UniformBufferObject {
 } ubo;
 
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec2 inTexCoord;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in mat4 inModel;
+layout(location = 6) in uvec4 inMaterial;
+layout(location = 7) in vec4 inTextureTransform;
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out uint fragTexture;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
-    fragColor = inColor;
-    fragTexCoord = inTexCoord;
+    gl_Position = ubo.proj * ubo.view * inModel * vec4(inPosition, 1.0);
+    fragColor = vec3(1.0);
+    fragTexCoord = inTextureTransform.xy + inTexCoord * inTextureTransform.zw;
+    fragTexture = inMaterial.x;
 }
\ No newline at end of file
@@ -0,0 +1,371 @@
+#include "simplify.h"
+#include "hash.h"
+
+namespace vkr::simplify {
+    namespace {
+        // Symmetric 4x4 plane quadric stored as its upper triangle, weighted by the area it was built from.
+        struct Quadric {
+            std::array<double, 10> a = {};
+            double weight = 0.0;
+
+            auto operator+=(const Quadric& other) -> Quadric& {
+                for (size_t i = 0; i < a.size(); ++i) {
+                    a[i] += other.a[i];
+                }
+                weight += other.weight;
+                return *this;
+            }
+        };
+
+        auto makeQuadric(const glm::dvec3& normal, double distance, double weight) -> Quadric {
+            Quadric quadric;
+            quadric.a = {
+                normal.x * normal.x, normal.x * normal.y, normal.x * normal.z, normal.x * distance,
+                normal.y * normal.y, normal.y * normal.z, normal.y * distance,
+                normal.z * normal.z, normal.z * distance,
+                distance * distance
+            };
+            for (double& value : quadric.a) {
+                value *= weight;
+            }
+            quadric.weight = weight;
+            return quadric;
+        }
+
+        // Mean squared distance from the point to the planes accumulated in the quadric.
+        auto evaluate(const Quadric& quadric, const glm::dvec3& p) -> double {
+            const std::array<double, 10>& a = quadric.a;
+            double error =
+                a[0] * p.x * p.x + 2.0 * a[1] * p.x * p.y + 2.0 * a[2] * p.x * p.z + 2.0 * a[3] * p.x +
+                a[4] * p.y * p.y + 2.0 * a[5] * p.y * p.z + 2.0 * a[6] * p.y +
+                a[7] * p.z * p.z + 2.0 * a[8] * p.z +
+                a[9];
+            return quadric.weight > 0.0 ? std::max(error / quadric.weight, 0.0) : 0.0;
+        }
+
+        struct Buckets {
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> items;
+
+            auto get(uint32_t bucket) const -> std::span<const uint32_t> {
+                return std::span<const uint32_t>(items).subspan(offsets[bucket], offsets[bucket + 1] - offsets[bucket]);
+            }
+        };
+
+        template <class F>
+        auto buildBuckets(size_t bucketCount, size_t itemCount, F&& bucketOf) -> Buckets {
+            Buckets buckets;
+            buckets.offsets.assign(bucketCount + 1, 0);
+            for (size_t i = 0; i < itemCount; ++i) {
+                if (uint32_t bucket = bucketOf(i); bucket != std::numeric_limits<uint32_t>::max()) {
+                    buckets.offsets[bucket + 1]++;
+                }
+            }
+            for (size_t i = 0; i < bucketCount; ++i) {
+                buckets.offsets[i + 1] += buckets.offsets[i];
+            }
+
+            std::vector<uint32_t> fill(buckets.offsets.begin(), buckets.offsets.end() - 1);
+            buckets.items.resize(buckets.offsets.back());
+            for (size_t i = 0; i < itemCount; ++i) {
+                if (uint32_t bucket = bucketOf(i); bucket != std::numeric_limits<uint32_t>::max()) {
+                    buckets.items[fill[bucket]++] = static_cast<uint32_t>(i);
+                }
+            }
+            return buckets;
+        }
+
+        auto getEdgeKey(uint32_t a, uint32_t b) -> uint64_t {
+            return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+        }
+
+        enum class Kind : uint8_t {
+            eInterior,
+            eBorder,
+            eLocked
+        };
+
+        struct Collapse {
+            uint32_t from = 0;
+            uint32_t to = 0;
+            double error = 0.0;
+        };
+    }
+
+    // Greedy half-edge collapse driven by plane quadrics. Vertices only ever collapse onto existing vertices, so every level
+    // can share the source vertex buffer. Vertices that share a position but not attributes (UV seams) collapse together
+    // onto matching vertices on the same side of the seam, and open borders may only slide along themselves.
+    auto simplify(std::span<const uint32_t> indices, std::span<const data::Vertex> vertices, size_t targetIndexCount, float targetError) -> Result {
+        Result result;
+        result.indices.assign(indices.begin(), indices.begin() + static_cast<ptrdiff_t>(indices.size() / 3 * 3));
+        if (result.indices.size() <= targetIndexCount) {
+            return result;
+        }
+
+        std::vector<uint32_t> positionOf(vertices.size());
+        std::vector<glm::dvec3> points;
+        {
+            hash::Table<glm::vec3, uint32_t> uniquePositions(vertices.size());
+            for (size_t i = 0; i < vertices.size(); ++i) {
+                auto [position, inserted] = uniquePositions.tryEmplace(vertices[i].position, static_cast<uint32_t>(points.size()));
+                if (inserted) {
+                    points.emplace_back(vertices[i].position);
+                }
+                positionOf[i] = position;
+            }
+        }
+
+        std::vector<Quadric> quadrics(points.size());
+        hash::Table<uint64_t, uint32_t> edgeCounts(result.indices.size());
+
+        for (size_t i = 0; i < result.indices.size(); i += 3) {
+            std::array<uint32_t, 3> corners = { positionOf[result.indices[i]], positionOf[result.indices[i + 1]], positionOf[result.indices[i + 2]] };
+
+            glm::dvec3 normal = glm::cross(points[corners[1]] - points[corners[0]], points[corners[2]] - points[corners[0]]);
+            double area = glm::length(normal);
+            if (area > 0.0) {
+                normal /= area;
+                Quadric quadric = makeQuadric(normal, -glm::dot(normal, points[corners[0]]), area * 0.5);
+                for (uint32_t corner : corners) {
+                    quadrics[corner] += quadric;
+                }
+            }
+
+            for (size_t corner = 0; corner < 3; ++corner) {
+                uint32_t a = corners[corner];
+                uint32_t b = corners[(corner + 1) % 3];
+                if (a != b) {
+                    edgeCounts.tryEmplace(getEdgeKey(a, b), 0).first++;
+                }
+            }
+        }
+
+        auto isBorderEdge = [&](uint32_t a, uint32_t b) {
+            uint32_t* count = edgeCounts.find(getEdgeKey(a, b));
+            return count && *count == 1;
+        };
+
+        std::vector<uint32_t> borderEdges(points.size(), 0);
+        std::vector<Kind> kinds(points.size(), Kind::eInterior);
+
+        for (size_t i = 0; i < result.indices.size(); i += 3) {
+            std::array<uint32_t, 3> corners = { positionOf[result.indices[i]], positionOf[result.indices[i + 1]], positionOf[result.indices[i + 2]] };
+            glm::dvec3 normal = glm::cross(points[corners[1]] - points[corners[0]], points[corners[2]] - points[corners[0]]);
+
+            for (size_t corner = 0; corner < 3; ++corner) {
+                uint32_t a = corners[corner];
+                uint32_t b = corners[(corner + 1) % 3];
+                if (a == b) {
+                    continue;
+                }
+
+                uint32_t count = *edgeCounts.find(getEdgeKey(a, b));
+                if (count > 2) {
+                    kinds[a] = Kind::eLocked;
+                    kinds[b] = Kind::eLocked;
+                }
+                else if (count == 1) {
+                    borderEdges[a]++;
+                    borderEdges[b]++;
+
+                    // A plane through the border edge, perpendicular to its face, keeps the outline from shrinking.
+                    glm::dvec3 edge = points[b] - points[a];
+                    glm::dvec3 perpendicular = glm::cross(edge, normal);
+                    double length = glm::length(perpendicular);
+                    if (length > 0.0) {
+                        perpendicular /= length;
+                        Quadric quadric = makeQuadric(perpendicular, -glm::dot(perpendicular, points[a]), glm::dot(edge, edge) * borderWeight);
+                        quadrics[a] += quadric;
+                        quadrics[b] += quadric;
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < points.size(); ++i) {
+            if (kinds[i] == Kind::eLocked || borderEdges[i] == 0) {
+                continue;
+            }
+            kinds[i] = borderEdges[i] == 2 ? Kind::eBorder : Kind::eLocked;
+        }
+
+        double errorLimit = static_cast<double>(targetError) * static_cast<double>(targetError);
+        double maxError = 0.0;
+
+        std::vector<uint32_t> remap(vertices.size());
+        std::vector<uint8_t> touched(points.size());
+        std::vector<uint8_t> referenced(vertices.size());
+        std::vector<Collapse> collapses;
+        std::vector<std::pair<uint32_t, uint32_t>> moves;
+
+        while (result.indices.size() > targetIndexCount) {
+            std::vector<uint32_t>& current = result.indices;
+            size_t triangleCount = current.size() / 3;
+
+            Buckets triangles = buildBuckets(points.size(), current.size(), [&](size_t i) {
+                return positionOf[current[i]];
+            });
+
+            std::fill(referenced.begin(), referenced.end(), 0);
+            for (uint32_t index : current) {
+                referenced[index] = 1;
+            }
+            Buckets wedges = buildBuckets(points.size(), vertices.size(), [&](size_t i) {
+                return referenced[i] ? positionOf[i] : std::numeric_limits<uint32_t>::max();
+            });
+
+            collapses.clear();
+            for (size_t i = 0; i < current.size(); ++i) {
+                uint32_t a = current[i];
+                uint32_t b = current[i - i % 3 + (i % 3 + 1) % 3];
+                uint32_t pa = positionOf[a];
+                uint32_t pb = positionOf[b];
+                if (pa == pb) {
+                    continue;
+                }
+
+                for (auto [from, to] : { std::pair(a, b), std::pair(b, a) }) {
+                    uint32_t pf = positionOf[from];
+                    uint32_t pt = positionOf[to];
+                    if (kinds[pf] == Kind::eLocked || (kinds[pf] == Kind::eBorder && !isBorderEdge(pf, pt))) {
+                        continue;
+                    }
+
+                    Quadric quadric = quadrics[pf];
+                    quadric += quadrics[pt];
+                    double error = evaluate(quadric, points[pt]);
+                    if (error <= errorLimit) {
+                        collapses.push_back({ from, to, error });
+                    }
+                }
+            }
+
+            if (collapses.empty()) {
+                break;
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+                return a.error < b.error;
+            });
+
+            std::iota(remap.begin(), remap.end(), 0u);
+            std::fill(touched.begin(), touched.end(), 0);
+
+            size_t targetTriangles = targetIndexCount / 3;
+            size_t remaining = triangleCount;
+            size_t applied = 0;
+
+            for (const Collapse& collapse : collapses) {
+                if (remaining <= targetTriangles) {
+                    break;
+                }
+
+                uint32_t pf = positionOf[collapse.from];
+                uint32_t pt = positionOf[collapse.to];
+                if (touched[pf] || touched[pt]) {
+                    continue;
+                }
+
+                // Every attribute variant at the source position needs a partner at the target that it shares an edge with,
+                // otherwise the collapse would tear a seam open.
+                moves.clear();
+                bool valid = true;
+                for (uint32_t wedge : wedges.get(pf)) {
+                    if (wedge == collapse.from) {
+                        moves.emplace_back(wedge, collapse.to);
+                        continue;
+                    }
+
+                    uint32_t partner = std::numeric_limits<uint32_t>::max();
+                    for (uint32_t corner : triangles.get(pf)) {
+                        size_t base = corner - corner % 3;
+                        if (remap[current[corner]] != wedge) {
+                            continue;
+                        }
+                        for (size_t k = 0; k < 3; ++k) {
+                            uint32_t vertex = remap[current[base + k]];
+                            if (positionOf[vertex] == pt) {
+                                partner = vertex;
+                            }
+                        }
+                    }
+
+                    if (partner == std::numeric_limits<uint32_t>::max()) {
+                        valid = false;
+                        break;
+                    }
+                    moves.emplace_back(wedge, partner);
+                }
+
+                size_t removed = 0;
+                for (uint32_t corner : triangles.get(pf)) {
+                    if (!valid) {
+                        break;
+                    }
+
+                    size_t base = corner - corner % 3;
+                    std::array<uint32_t, 3> before;
+                    for (size_t k = 0; k < 3; ++k) {
+                        before[k] = positionOf[remap[current[base + k]]];
+                    }
+
+                    if (before[0] == before[1] || before[1] == before[2] || before[2] == before[0]) {
+                        continue;
+                    }
+
+                    std::array<uint32_t, 3> after = before;
+                    for (uint32_t& position : after) {
+                        position = position == pf ? pt : position;
+                    }
+
+                    if (after[0] == after[1] || after[1] == after[2] || after[2] == after[0]) {
+                        removed++;
+                        continue;
+                    }
+
+                    glm::dvec3 normalBefore = glm::cross(points[before[1]] - points[before[0]], points[before[2]] - points[before[0]]);
+                    glm::dvec3 normalAfter = glm::cross(points[after[1]] - points[after[0]], points[after[2]] - points[after[0]]);
+                    double lengthBefore = glm::length(normalBefore);
+                    double lengthAfter = glm::length(normalAfter);
+                    valid = lengthAfter > 0.0 ? glm::dot(normalBefore, normalAfter) > maxNormalRotation * lengthBefore * lengthAfter : lengthBefore == 0.0;
+                }
+
+                if (!valid) {
+                    continue;
+                }
+
+                removed = std::min(removed, remaining);
+
+                for (auto [from, to] : moves) {
+                    remap[from] = to;
+                }
+                touched[pf] = 1;
+                touched[pt] = 1;
+                quadrics[pt] += quadrics[pf];
+                maxError = std::max(maxError, collapse.error);
+                remaining -= removed;
+                applied++;
+            }
+
+            if (applied == 0) {
+                break;
+            }
+
+            size_t write = 0;
+            for (size_t i = 0; i < current.size(); i += 3) {
+                uint32_t a = remap[current[i]];
+                uint32_t b = remap[current[i + 1]];
+                uint32_t c = remap[current[i + 2]];
+                if (positionOf[a] != positionOf[b] && positionOf[b] != positionOf[c] && positionOf[c] != positionOf[a]) {
+                    current[write++] = a;
+                    current[write++] = b;
+                    current[write++] = c;
+                }
+            }
+            current.resize(write);
+        }
+
+        result.error = static_cast<float>(std::sqrt(maxError));
+        return result;
+    }
+}
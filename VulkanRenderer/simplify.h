@@ -0,0 +1,14 @@
+#pragma once
+#include "data.h"
+
+namespace vkr::simplify {
+    constexpr float borderWeight = 10.0f;
+    constexpr float maxNormalRotation = 0.25f;
+
+    struct Result {
+        std::vector<uint32_t> indices;
+        float error = 0.0f;
+    };
+
+    auto simplify(std::span<const uint32_t> indices, std::span<const data::Vertex> vertices, size_t targetIndexCount, float targetError) -> Result;
+}
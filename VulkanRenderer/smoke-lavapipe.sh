@@ -0,0 +1,23 @@
+#!/bin/sh
+# Builds the renderer and renders ten offscreen benchmark frames on Mesa's lavapipe, which needs neither a GPU nor a
+# display. BUILD_DIR defaults to build/ next to this directory; VK_DRIVER_FILES can point at another lavapipe ICD.
+set -eu
+
+root=$(cd "$(dirname "$0")" && pwd)
+build=${BUILD_DIR:-$root/../build}
+driver=${VK_DRIVER_FILES:-/usr/share/vulkan/icd.d/lvp_icd.x86_64.json}
+
+cmake -S "$root" -B "$build" -DCMAKE_BUILD_TYPE=Release
+cmake --build "$build" -j "$(nproc)"
+
+# The renderer loads its shaders, models and textures relative to the working directory.
+cd "$root"
+output="$build/smoke.json"
+rm -f "$output"
+# Loaders older than 1.3.207 only read VK_ICD_FILENAMES.
+VK_DRIVER_FILES=$driver VK_ICD_FILENAMES=$driver "$build/VulkanRenderer" bench --frames 10 --output "$output"
+
+if ! grep -q '"frames": 10,' "$output"; then
+    echo "smoke-lavapipe: $output doesn't report 10 frames" >&2
+    exit 1
+fi
@@ -0,0 +1,133 @@
+#include "transcode.h"
+#include "bc.h"
+#include "ktx.h"
+#include "parallel.h"
+
+namespace vkr::transcode {
+    auto parseOptions(std::span<char*> arguments) -> Options {
+        Options options;
+
+        for (size_t i = 0; i < arguments.size(); ++i) {
+            std::string_view argument = arguments[i];
+
+            auto value = [&]() -> std::string {
+                if (i + 1 >= arguments.size()) {
+                    throw std::runtime_error(fmt::format("Missing value for {}", argument));
+                }
+                return arguments[++i];
+            };
+
+            if (argument == "--format") {
+                options.format = value();
+            }
+            else if (argument == "--filter") {
+                std::string filter = value();
+                if (filter == "box") {
+                    options.filter = mip::Filter::eBox;
+                }
+                else if (filter == "kaiser") {
+                    options.filter = mip::Filter::eKaiser;
+                }
+                else {
+                    throw std::runtime_error(fmt::format("Unknown filter {}, expected box or kaiser", filter));
+                }
+            }
+            else if (argument == "--linear") {
+                options.linear = true;
+            }
+            else if (argument == "--force") {
+                options.force = true;
+            }
+            else if (argument.starts_with("--")) {
+                throw std::runtime_error(fmt::format("Unknown option {}", argument));
+            }
+            else {
+                options.inputs.emplace_back(argument);
+            }
+        }
+
+        if (options.inputs.empty()) {
+            for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator("textures")) {
+                std::filesystem::path extension = entry.path().extension();
+                if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg" || extension == ".jpeg")) {
+                    options.inputs.push_back(entry.path().string());
+                }
+            }
+            std::sort(options.inputs.begin(), options.inputs.end());
+        }
+
+        return options;
+    }
+
+    // Color formats are sRGB unless --linear is given. BC4 and BC5 hold data rather than color and are always linear.
+    auto getFormat(const Options& options) -> vk::Format {
+        if (options.format == "bc1") {
+            return options.linear ? vk::Format::eBc1RgbUnormBlock : vk::Format::eBc1RgbSrgbBlock;
+        }
+        if (options.format == "bc3") {
+            return options.linear ? vk::Format::eBc3UnormBlock : vk::Format::eBc3SrgbBlock;
+        }
+        if (options.format == "bc4") {
+            return vk::Format::eBc4UnormBlock;
+        }
+        if (options.format == "bc5") {
+            return vk::Format::eBc5UnormBlock;
+        }
+        if (options.format == "bc7") {
+            return options.linear ? vk::Format::eBc7UnormBlock : vk::Format::eBc7SrgbBlock;
+        }
+        if (options.format == "rgba8") {
+            return options.linear ? vk::Format::eR8G8B8A8Unorm : vk::Format::eR8G8B8A8Srgb;
+        }
+        throw std::runtime_error(fmt::format("Unknown format {}, expected bc1, bc3, bc4, bc5, bc7 or rgba8", options.format));
+    }
+
+    // Writes a .ktx2 with the full mip chain next to every input, where data::Texture picks it up in place of the image.
+    auto run(std::span<char*> arguments) -> int {
+        using Clock = std::chrono::steady_clock;
+
+        try {
+            Options options = parseOptions(arguments);
+            vk::Format format = getFormat(options);
+            bool compressed = bc::getBlockSize(format) != 0;
+            vk::Format sourceFormat = compressed ? bc::getDecompressedFormat(format) : format;
+
+            parallel::ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+            for (const std::string& input : options.inputs) {
+                std::filesystem::path output = std::filesystem::path(input).replace_extension(".ktx2");
+                if (!options.force && std::filesystem::exists(output) && std::filesystem::last_write_time(output) >= std::filesystem::last_write_time(input)) {
+                    spdlog::info("{} is up to date", output.string());
+                    continue;
+                }
+
+                auto start = Clock::now();
+
+                data::Texture loaded(input.c_str(), false);
+                data::Texture source(sourceFormat, loaded.getDimentions(), std::vector<uint8_t>(loaded.getPixels(), loaded.getPixels() + loaded.getSize()), std::vector<data::TextureLevel>(loaded.getLevels().begin(), loaded.getLevels().end()));
+                data::Texture texture = mip::buildMipChain(pool, source, options.filter);
+                size_t uncompressedSize = texture.getSize();
+                if (compressed) {
+                    texture = bc::compress(pool, texture, format);
+                }
+                ktx::write(output.string().c_str(), texture);
+
+                spdlog::info("{} -> {}: {}x{}, {} levels, {:.1f} KiB -> {:.1f} KiB in {:.0f} ms",
+                    input,
+                    output.string(),
+                    texture.getDimentions().x,
+                    texture.getDimentions().y,
+                    texture.getLevels().size(),
+                    uncompressedSize / 1024.0,
+                    texture.getSize() / 1024.0,
+                    std::chrono::duration<double, std::milli>(Clock::now() - start).count()
+                );
+            }
+        }
+        catch (const std::exception& e) {
+            spdlog::error(e.what());
+            return 1;
+        }
+        return 0;
+    }
+}
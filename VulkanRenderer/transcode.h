@@ -0,0 +1,17 @@
+#pragma once
+#include "data.h"
+#include "mip.h"
+
+namespace vkr::transcode {
+    struct Options {
+        std::string format = "bc7";
+        mip::Filter filter = mip::defaultFilter;
+        bool linear = false;
+        bool force = false;
+        std::vector<std::string> inputs;
+    };
+
+    auto parseOptions(std::span<char*> arguments) -> Options;
+    auto getFormat(const Options& options) -> vk::Format;
+    auto run(std::span<char*> arguments) -> int;
+}